@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 template <typename T>
 class Evolver {
  public:
@@ -13,4 +15,19 @@ class Evolver {
 
   // Given one single speciment, performs a random mutation.
   virtual T Mutate(const T& specimen) = 0;
+
+  // Like Mate, but writes the offspring to an existing specimen. out may be a
+  // specimen that is no longer needed; subclasses can reuse its storage. out
+  // must not alias the parents.
+  virtual void MateInto(const T& father, const T& mother, T* out) {
+    *out = Mate(father, mother);
+  }
+
+  // Like Mutate, but changes the specimen in place.
+  virtual void MutateInPlace(T* specimen) { *specimen = Mutate(*specimen); }
+
+  // Called once at the end of each generation with the survivors, which form
+  // the next generation, and the specimens that were killed. The storage of
+  // the killed specimens is reused by MateInto unless they are removed.
+  virtual void EndGeneration(std::vector<T>*, std::vector<T>*) {}
 };
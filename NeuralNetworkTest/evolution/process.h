@@ -4,12 +4,17 @@
 #include <vector>
 
 #include "evolution/evolver.h"
+#include "util/concurrency/thread_pool.h"
 
 template <typename T>
 class Process {
  public:
   using FitnessFunction = std::function<double(const T&)>;
   using Generation = std::vector<T>;
+  // Writes the fitness of each specimen of a generation to a vector, in the
+  // order of the generation.
+  using BatchFitnessFunction =
+      std::function<void(const Generation&, std::vector<double>*)>;
 
   struct Options {
     // How natural selection works.
@@ -35,6 +40,15 @@ class Process {
 
     // The number of children that are caused by each pair of parents.
     int offspring_count;
+
+    // If set, this is used instead of the fitness function to score all
+    // specimens of a generation at once, e.g. when the fitness of a specimen
+    // depends on the others.
+    BatchFitnessFunction batch_fitness_function{};
+
+    // If set, the fitness function is evaluated for the specimens of a
+    // generation in parallel on this pool, so it must be thread-safe.
+    ::util::concurrency::ThreadPool* thread_pool = nullptr;
   };
 
   // Runs a process of evolution and returns the resulting speciment.
@@ -54,24 +68,25 @@ class Process {
           Options options);
 
   // Runs a process of evolution and returns the resulting specimen.
-  Generation RunProcess() const;
+  Generation RunProcess();
 
-  // Evolves one generation to the next.
-  Generation Evolve(const Generation& old_generation) const;
+  // Evolves one generation to the next. The offspring is written to
+  // *offspring, whose elements are dead specimens whose storage is reused.
+  void Evolve(const Generation& old_generation, Generation* offspring);
 
-  // Mates two specimen to create part of a new generation.
-  Generation Mate(const T& father, const T& mother) const;
+  // Kills all weak specimen, i.e. sorts the generation so that the survivors
+  // come first.
+  void NaturalSelection(Generation* generation) const;
 
   // Kills all weak specimen.
-  Generation NaturalSelection(const Generation& old_generation) const;
+  void NaturalSelection_KillPreciseWorst(Generation* generation) const;
 
   // Kills all weak specimen.
-  Generation NaturalSelection_KillPreciseWorst(
-      const Generation& old_generation) const;
+  void NaturalSelection_KillProbabWorst(Generation* generation) const;
 
-  // Kills all weak specimen.
-  Generation NaturalSelection_KillProbabWorst(
-      const Generation& old_generation) const;
+  // Kills all weak specimen, scoring the whole generation at once with the
+  // batch fitness function or the thread pool.
+  void NaturalSelection_Scores(Generation* generation) const;
 
   // Compares two T values according to their fitness.
   static bool FitnessComparison(const T& lhs, const T& rhs);
@@ -1,6 +1,9 @@
 
 #include <algorithm>
+#include <iterator>
+#include <numeric>
 
+#include "util/permute.h"
 #include "util/random/probabilistic_sort.h"
 #include "util/sort.h"
 
@@ -24,7 +27,7 @@ Process<T>::Process(Evolver<T>* evolver, FitnessFunction fitness_function,
       options_(std::move(options)) {}
 
 template <typename T>
-typename Process<T>::Generation Process<T>::RunProcess() const {
+typename Process<T>::Generation Process<T>::RunProcess() {
   // Construct initial generation of random specimen.
   Generation current_generation = options_.starting_generation;
   while (current_generation.size() < options_.generation_size) {
@@ -32,84 +35,118 @@ typename Process<T>::Generation Process<T>::RunProcess() const {
   }
   current_generation.erase(current_generation.begin() + options_.generation_size, current_generation.end());
 
-  // Run through the generations.
+  // Run through the generations. Specimens that die are kept in this pool, so
+  // their storage can be reused for the children of the next generation.
+  Generation offspring;
   while (!options_.evolution_terminate(current_generation)) {
-    current_generation = NaturalSelection(Evolve(current_generation));
+    Evolve(current_generation, &offspring);
+    NaturalSelection(&offspring);
+
+    // The parents and the killed children become the pool.
+    current_generation.swap(offspring);
+    std::move(current_generation.begin() + options_.generation_size,
+              current_generation.end(), std::back_inserter(offspring));
+    current_generation.erase(
+        current_generation.begin() + options_.generation_size,
+        current_generation.end());
+    evolver_->EndGeneration(&current_generation, &offspring);
   }
   return current_generation;
 }
 
 template <typename T>
-typename Process<T>::Generation Process<T>::Evolve(
-    const Generation& old_generation) const {
+void Process<T>::Evolve(const Generation& old_generation,
+                        Generation* offspring) {
   // Mate all specimen with each other.
-  Generation new_generation;
+  unsigned int child_number = 0;
   for (auto iter1 = old_generation.begin(); iter1 != old_generation.end();
        ++iter1) {
     for (auto iter2 = std::next(iter1); iter2 != old_generation.end();
          ++iter2) {
-      Generation offspring = Mate(*iter1, *iter2);
-      std::move(offspring.begin(), offspring.end(),
-                std::back_inserter(new_generation));
+      for (int i = 0; i < options_.offspring_count; ++i) {
+        if (child_number < offspring->size()) {
+          evolver_->MateInto(*iter1, *iter2, &(*offspring)[child_number]);
+        } else {
+          offspring->push_back(evolver_->Mate(*iter1, *iter2));
+        }
+        evolver_->MutateInPlace(&(*offspring)[child_number]);
+        ++child_number;
+      }
     }
   }
-  return new_generation;
+  offspring->erase(offspring->begin() + child_number, offspring->end());
 }
 
 template <typename T>
-typename Process<T>::Generation Process<T>::Mate(const T& father,
-                                                 const T& mother) const {
-  Generation offspring;
-  const auto mate_and_mutate = [this, &father, &mother]() {
-    return evolver_->Mutate(evolver_->Mate(father, mother));
-  };
-  std::generate_n(std::back_inserter(offspring), options_.offspring_count,
-                  mate_and_mutate);
-  return offspring;
-}
-
-template <typename T>
-typename Process<T>::Generation Process<T>::NaturalSelection(
-    const Generation& old_generation) const {
+void Process<T>::NaturalSelection(Generation* generation) const {
+  if (options_.batch_fitness_function || options_.thread_pool) {
+    NaturalSelection_Scores(generation);
+    return;
+  }
   switch (options_.natural_selection_strategy) {
     case Options::KILL_PRECISE_WORST:
-      return NaturalSelection_KillPreciseWorst(old_generation);
+      NaturalSelection_KillPreciseWorst(generation);
+      break;
     case Options::KILL_PROBAB_WORST:
-      return NaturalSelection_KillProbabWorst(old_generation);
+      NaturalSelection_KillProbabWorst(generation);
+      break;
     default:
       throw "Unsupported natural selection strategy.";
   }
 }
 
 template <typename T>
-typename Process<T>::Generation Process<T>::NaturalSelection_KillPreciseWorst(
-    const Generation& old_generation) const {
-  // Sort the old generation by descending fitness.
-  Generation new_generation = old_generation;
+void Process<T>::NaturalSelection_KillPreciseWorst(
+    Generation* generation) const {
+  // Sort the generation by descending fitness.
   const auto negative_fitness = [this](const T& specimen) {
     return -fitness_function_(specimen);
   };
-  ::util::sort::Sort(new_generation.begin(), new_generation.end(),
-                     negative_fitness);
+  ::util::sort::Sort(generation->begin(), generation->end(), negative_fitness);
+}
 
-  // Only keep the first n elements in the sorted list.
-  new_generation.erase(new_generation.begin() + options_.generation_size,
-                       new_generation.end());
-  return new_generation;
+template <typename T>
+void Process<T>::NaturalSelection_KillProbabWorst(
+    Generation* generation) const {
+  // Sort the generation approximately by descending fitness.
+  ::util::random::ProbabilisticSort(generation->begin(), generation->end(),
+                                    fitness_function_);
 }
 
 template <typename T>
-typename Process<T>::Generation Process<T>::NaturalSelection_KillProbabWorst(
-    const Generation& old_generation) const {
-  // Sort the old generation approximately by descending fitness.
-  Generation new_generation = old_generation;
-  ::util::random::ProbabilisticSort(new_generation.begin(),
-                                    new_generation.end(), fitness_function_);
-
-  // Only keep the first n elements in the sorted list.
-  new_generation.erase(new_generation.begin() + options_.generation_size,
-                       new_generation.end());
-  return new_generation;
+void Process<T>::NaturalSelection_Scores(Generation* generation) const {
+  std::vector<double> scores;
+  if (options_.batch_fitness_function) {
+    options_.batch_fitness_function(*generation, &scores);
+  } else {
+    scores.resize(generation->size());
+    ::util::concurrency::ParallelFor(
+        options_.thread_pool, 0, generation->size(), 1,
+        [this, generation, &scores](int i) {
+          scores[i] = fitness_function_((*generation)[i]);
+        });
+  }
+
+  // Sort the indices of the specimens like the specimens would be sorted by
+  // the other strategies, then apply that order to the generation.
+  std::vector<unsigned int> order(scores.size());
+  std::iota(order.begin(), order.end(), 0);
+  switch (options_.natural_selection_strategy) {
+    case Options::KILL_PRECISE_WORST:
+      ::util::sort::Sort(order.begin(), order.end(),
+                         [&scores](unsigned int i) { return -scores[i]; });
+      break;
+    case Options::KILL_PROBAB_WORST:
+      ::util::random::ProbabilisticSort(
+          order.begin(), order.end(),
+          [&scores](unsigned int i) { return scores[i]; });
+      break;
+    default:
+      throw "Unsupported natural selection strategy.";
+  }
+  ::util::permute::InvertPermutation(order.begin(), order.end());
+  ::util::permute::Permute(generation->begin(), generation->end(),
+                           order.begin(), order.end());
 }
 
 template <typename T>
@@ -37,7 +37,8 @@ TEST(ProcessTest, EvolutionTest) {
         return false;
       };
   IntProcess::Options options;
-  options.natural_selection_strategy = KILL_PRECISE_WORST;
+  options.natural_selection_strategy =
+      IntProcess::Options::KILL_PRECISE_WORST;
   options.generation_size = 3;
   options.evolution_terminate =
       IntProcess::TerminateAfterNGenerations(2, register_generation);
@@ -60,3 +61,59 @@ TEST(ProcessTest, EvolutionTest) {
   EXPECT_EQ(generations[2][1], 7);
   EXPECT_EQ(generations[2][2], 7);
 }
+
+// The same process as in EvolutionTest, but scored in batches. The score of a
+// specimen is its rank in the generation, which orders them like their values.
+TEST(ProcessTest, BatchFitnessTest) {
+  std::vector<IntProcess::Generation> generations;
+  const auto register_generation =
+      [&generations](const IntProcess::Generation& generation) {
+        generations.push_back(generation);
+        return false;
+      };
+  int batches = 0;
+  IntProcess::Options options;
+  options.natural_selection_strategy =
+      IntProcess::Options::KILL_PRECISE_WORST;
+  options.generation_size = 3;
+  options.evolution_terminate =
+      IntProcess::TerminateAfterNGenerations(2, register_generation);
+  options.offspring_count = 2;
+  options.batch_fitness_function = [&batches](
+      const IntProcess::Generation& generation, std::vector<double>* scores) {
+    ++batches;
+    scores->clear();
+    for (const int specimen : generation) {
+      scores->push_back(std::count_if(
+          generation.begin(), generation.end(),
+          [specimen](int other) { return other < specimen; }));
+    }
+  };
+
+  EvolverForTest evolver;
+  const IntProcess::Generation generation =
+      IntProcess::Evolution(&evolver, nullptr, options);
+  EXPECT_EQ(batches, 2);
+  ASSERT_EQ(generations.size(), 3);
+  EXPECT_EQ(generations[1], IntProcess::Generation({4, 4, 3}));
+  EXPECT_EQ(generation, IntProcess::Generation({7, 7, 6}));
+}
+
+// The same process as in EvolutionTest, with the fitness evaluated in
+// parallel.
+TEST(ProcessTest, ThreadPoolTest) {
+  util::concurrency::ThreadPool pool(4);
+  IntProcess::Options options;
+  options.natural_selection_strategy =
+      IntProcess::Options::KILL_PRECISE_WORST;
+  options.generation_size = 3;
+  options.evolution_terminate = IntProcess::TerminateAfterNGenerations(2);
+  options.offspring_count = 2;
+  options.thread_pool = &pool;
+
+  EvolverForTest evolver;
+  IntProcess::Generation generation =
+      IntProcess::Evolution(&evolver, &FitnessFunctionForTest, options);
+  std::sort(generation.begin(), generation.end());
+  EXPECT_EQ(generation, IntProcess::Generation({6, 7, 7}));
+}
@@ -0,0 +1,55 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include "mnk/game.h"
+
+namespace {
+// Plays random games and prints the average time of a move, which includes
+// the incremental win check and the hash update.
+template <typename GameT>
+void BenchmarkPlayouts(const char* name, int games) {
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<int> x_distribution(0, GameT::kWidth - 1);
+  std::uniform_int_distribution<int> y_distribution(0, GameT::kHeight - 1);
+  long plies = 0;
+  uint64_t checksum = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < games; ++i) {
+    GameT game;
+    mnk::Player player = mnk::X;
+    while (!game.Over()) {
+      // Rejection sampling keeps the cost of picking a move independent of
+      // the board size for most of the game.
+      int x, y;
+      do {
+        x = x_distribution(generator);
+        y = (GameT::kGravity ? 0 : y_distribution(generator));
+        while (GameT::kGravity && y < GameT::kHeight &&
+               game.Tile(x, y) != mnk::None) {
+          ++y;
+        }
+      } while (!game.IsLegal(x, y));
+      game.Play(x, y, player);
+      player = (player == mnk::X ? mnk::O : mnk::X);
+      ++plies;
+    }
+    checksum ^= game.Hash();
+  }
+  const double nanoseconds = std::chrono::duration<double, std::nano>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+  std::cout << name << ": " << nanoseconds / plies << " ns/ply, "
+            << static_cast<double>(plies) / games << " plies/game (checksum "
+            << (checksum & 0xffff) << ")" << std::endl;
+}
+}
+
+int main() {
+  BenchmarkPlayouts<mnk::MNKGame<3, 3, 3>>("tic-tac-toe 3,3,3", 200000);
+  BenchmarkPlayouts<mnk::MNKGame<7, 6, 4, true>>("connect four 7,6,4",
+                                                  100000);
+  BenchmarkPlayouts<mnk::MNKGame<15, 15, 5>>("gomoku 15,15,5", 20000);
+  BenchmarkPlayouts<mnk::MNKGame<19, 19, 5>>("gomoku 19,19,5", 10000);
+  return 0;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "mnk/game.h"
+#include "nn/simple_network.h"
+
+namespace mnk {
+
+// The layer sizes of a network that plays GameT, given the sizes of its inner
+// layers. The output has one value per tile. These can be used as
+// SimpleNetworkEvolver::Options::layer_sizes.
+template <typename GameT>
+std::vector<int> NetworkLayerSizes(const std::vector<int>& inner_layers);
+
+// Calculates the moves of one network without allocating after construction.
+// The network must outlive the player.
+template <typename GameT>
+class NetworkPlayer {
+ public:
+  using Position = typename GameT::Position;
+
+  explicit NetworkPlayer(const SimpleNetwork* network);
+
+  // Lets this player use another network, reusing the memory if possible.
+  void SetNetwork(const SimpleNetwork* network);
+
+  // Selects the legal move with the highest output value; ties go to the lower
+  // output index. The game must not be over. The networks learn to play as O,
+  // so the stones are swapped in the input when playing as X.
+  Position NextMove(const GameT& game, Player player = O);
+
+ private:
+  const SimpleNetwork* network_;
+  SimpleNetwork::Workspace workspace_;
+  std::vector<double> input_;
+  std::vector<double> output_;
+  std::vector<Position> moves_;
+};
+
+// A simple deterministic opponent: completes a line if possible, otherwise
+// blocks a line of the other player if possible, otherwise takes the legal
+// tile closest to the center. The game must not be over.
+template <typename GameT>
+typename GameT::Position ScriptedMove(const GameT& game, Player player);
+
+// The final score of a game from the point of view of O: the number of free
+// tiles plus 1 if O won, minus that if X won and 0 otherwise. On a 3 x 3
+// board, this is the score of the tic-tac-toe fitness functions.
+template <typename GameT>
+double EndedGameScore(const GameT& game);
+
+// Calculates a fitness score of this network by having it play as O against
+// ScriptedMove, once with each player starting.
+template <typename GameT>
+struct FastFitness {
+ public:
+  FastFitness(const SimpleNetwork* network);
+
+  double operator()() const;
+
+ private:
+  // The score of a game in which X moves next.
+  double ScoreFrom(GameT game) const;
+
+  const SimpleNetwork* network_;
+  mutable NetworkPlayer<GameT> player_;
+};
+
+// Calculates a fitness score of this network by having it play as O against
+// every sequence of moves of X, like the tic-tac-toe slow fitness. Unlike that
+// one, a game ends as soon as a player wins instead of when the board is full.
+// On larger boards this is infeasible, so X only tries every move for its
+// first "branching_moves" moves and then plays ScriptedMove. Positions are
+// memoized by their Zobrist hash.
+template <typename GameT>
+struct SlowFitness {
+ public:
+  SlowFitness(const SimpleNetwork* network, int branching_moves);
+
+  double operator()() const;
+
+ private:
+  // The sum of the scores of all games that continue from a position in which
+  // X moves next. "moves" is the number of moves X made already.
+  double ScoreFrom(const GameT& game, int moves) const;
+
+  // The score of the games that continue after X plays x_move and the network
+  // answers.
+  double ScoreAfter(const GameT& game, typename GameT::Position x_move,
+                    int moves) const;
+
+  const SimpleNetwork* network_;
+  const int branching_moves_;
+  mutable NetworkPlayer<GameT> player_;
+  mutable std::unordered_map<uint64_t, double> memory_;
+  // The legal moves of X at each branching depth. A buffer is reused by all
+  // positions of its depth, so the search does not allocate per position.
+  mutable std::vector<std::vector<typename GameT::Position>> move_buffers_;
+};
+}
+
+#include "mnk/fitness.impl.h"
@@ -0,0 +1,198 @@
+#include <algorithm>
+
+#include "snowhouse/snowhouse.h"
+
+namespace mnk {
+
+template <typename GameT>
+std::vector<int> NetworkLayerSizes(const std::vector<int>& inner_layers) {
+  std::vector<int> result{GameT::kInputSize};
+  result.insert(result.end(), inner_layers.begin(), inner_layers.end());
+  result.push_back(GameT::kTiles);
+  return result;
+}
+
+template <typename GameT>
+NetworkPlayer<GameT>::NetworkPlayer(const SimpleNetwork* network)
+    : input_(GameT::kInputSize), output_(GameT::kTiles) {
+  moves_.reserve(GameT::kTiles);
+  SetNetwork(network);
+}
+
+template <typename GameT>
+void NetworkPlayer<GameT>::SetNetwork(const SimpleNetwork* network) {
+  const unsigned int input_size = GameT::kInputSize;
+  const unsigned int output_size = GameT::kTiles;
+  try {
+    AssertThat(network->LayerSize(0), snowhouse::Equals(input_size));
+    AssertThat(network->LayerSize(network->LayerNumber() - 1),
+               snowhouse::Equals(output_size));
+  } catch (const snowhouse::AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+  network_ = network;
+  workspace_.Reserve(*network);
+}
+
+template <typename GameT>
+typename NetworkPlayer<GameT>::Position NetworkPlayer<GameT>::NextMove(
+    const GameT& game, Player player) {
+  game.ToNetworkInput(input_.data());
+  if (player == X) {
+    for (int i = 0; i < GameT::kTiles; ++i) {
+      input_[i] = -input_[i];
+    }
+  }
+  network_->Forward(input_.data(), output_.data(), &workspace_);
+  game.LegalMoves(&moves_);
+  Position best = moves_.front();
+  int best_index = GameT::TileIndex(best.first, best.second);
+  for (const Position& move : moves_) {
+    const int index = GameT::TileIndex(move.first, move.second);
+    if (output_[index] > output_[best_index] ||
+        (output_[index] == output_[best_index] && index < best_index)) {
+      best = move;
+      best_index = index;
+    }
+  }
+  return best;
+}
+
+template <typename GameT>
+typename GameT::Position ScriptedMove(const GameT& game, Player player) {
+  using Position = typename GameT::Position;
+  const Player other = (player == X ? O : X);
+  thread_local std::vector<Position> moves;
+  game.LegalMoves(&moves);
+
+  // Complete a line if possible.
+  for (const Position& move : moves) {
+    if (game.WouldWin(move.first, move.second, player)) {
+      return move;
+    }
+  }
+
+  // Stop a line if possible.
+  for (const Position& move : moves) {
+    if (game.WouldWin(move.first, move.second, other)) {
+      return move;
+    }
+  }
+
+  // Take the tile closest to the center. Distances are doubled so that they
+  // are integers.
+  Position best = moves.front();
+  int best_distance = -1;
+  for (const Position& move : moves) {
+    const int dx = 2 * move.first - (GameT::kWidth - 1);
+    const int dy = 2 * move.second - (GameT::kHeight - 1);
+    const int distance = dx * dx + dy * dy;
+    if (best_distance < 0 || distance < best_distance) {
+      best = move;
+      best_distance = distance;
+    }
+  }
+  return best;
+}
+
+template <typename GameT>
+double EndedGameScore(const GameT& game) {
+  const double free_tiles_plus_one = GameT::kTiles + 1 - game.Turns();
+  if (game.Winner() == O) {
+    return free_tiles_plus_one;
+  }
+  if (game.Winner() == X) {
+    return -free_tiles_plus_one;
+  }
+  return 0.0;
+}
+
+template <typename GameT>
+FastFitness<GameT>::FastFitness(const SimpleNetwork* network)
+    : network_(network), player_(network) {}
+
+template <typename GameT>
+double FastFitness<GameT>::operator()() const {
+  network_->Compile();
+
+  GameT human_start;
+  GameT ai_start;
+  ai_start.Play(player_.NextMove(ai_start), O);
+  return ScoreFrom(human_start) + ScoreFrom(ai_start);
+}
+
+template <typename GameT>
+double FastFitness<GameT>::ScoreFrom(GameT game) const {
+  for (;;) {
+    if (game.Over()) {
+      return EndedGameScore(game);
+    }
+    game.Play(ScriptedMove(game, X), X);
+    if (game.Over()) {
+      return EndedGameScore(game);
+    }
+    game.Play(player_.NextMove(game), O);
+  }
+}
+
+template <typename GameT>
+SlowFitness<GameT>::SlowFitness(const SimpleNetwork* network,
+                                int branching_moves)
+    : network_(network),
+      branching_moves_(branching_moves),
+      player_(network),
+      move_buffers_(std::max(branching_moves, 0)) {}
+
+template <typename GameT>
+double SlowFitness<GameT>::operator()() const {
+  network_->Compile();
+  memory_.clear();
+
+  GameT human_start;
+  GameT ai_start;
+  ai_start.Play(player_.NextMove(ai_start), O);
+  return ScoreFrom(human_start, 0) + ScoreFrom(ai_start, 0);
+}
+
+template <typename GameT>
+double SlowFitness<GameT>::ScoreFrom(const GameT& game, int moves) const {
+  if (game.Over()) {
+    return EndedGameScore(game);
+  }
+
+  // The number of moves of X is the number of its stones, so the position
+  // identifies the score.
+  const uint64_t key = game.Hash();
+  const auto memorized = memory_.find(key);
+  if (memorized != memory_.end()) {
+    return memorized->second;
+  }
+
+  double score = 0.0;
+  if (moves < branching_moves_) {
+    std::vector<typename GameT::Position>& x_moves = move_buffers_[moves];
+    game.LegalMoves(&x_moves);
+    for (const typename GameT::Position& x_move : x_moves) {
+      score += ScoreAfter(game, x_move, moves);
+    }
+  } else {
+    score = ScoreAfter(game, ScriptedMove(game, X), moves);
+  }
+  memory_[key] = score;
+  return score;
+}
+
+template <typename GameT>
+double SlowFitness<GameT>::ScoreAfter(const GameT& game,
+                                      typename GameT::Position x_move,
+                                      int moves) const {
+  GameT next = game;
+  next.Play(x_move, X);
+  if (!next.Over()) {
+    next.Play(player_.NextMove(next), O);
+  }
+  return ScoreFrom(next, moves + 1);
+}
+}
@@ -0,0 +1,156 @@
+
+#include <random>
+
+#include "evolution/process.h"
+#include "mnk/fitness.h"
+#include "nn/simple_network_evolver.h"
+#include "nn/simple_network_testing.h"
+#include "tictactoe/opponent_table.h"
+#include "tictactoe/simple_network_support.h"
+#include "gtest/gtest.h"
+
+namespace {
+using MNKTicTacToe = mnk::MNKGame<3, 3, 3>;
+using ConnectFour = mnk::MNKGame<7, 6, 4, true>;
+
+SimpleNetworkEvolver ConstructEvolver(const std::vector<int>& layer_sizes) {
+  SimpleNetworkEvolver::Options options;
+  options.layer_sizes = layer_sizes;
+  options.mutation_grow_chance = 0.5;
+  options.mutation_weight_chance = 0.5;
+  return SimpleNetworkEvolver(options);
+}
+
+// Plays mnk::ScriptedMove on a tic-tac-toe board.
+TicTacToe::Game::Position MNKScriptedMove(const TicTacToe::Game& game) {
+  MNKTicTacToe mnk_game;
+  for (int x = 0; x < 3; ++x) {
+    for (int y = 0; y < 3; ++y) {
+      if (game.Tile(x, y) == TicTacToe::X) {
+        mnk_game.Play(x, y, mnk::X);
+      } else if (game.Tile(x, y) == TicTacToe::O) {
+        mnk_game.Play(x, y, mnk::O);
+      }
+    }
+  }
+  return mnk::ScriptedMove(mnk_game, mnk::X);
+}
+
+// The score of all tic-tac-toe games that continue from a position in which X
+// moves next, like mnk::SlowFitness with unlimited branching.
+double TicTacToeSlowScore(const TicTacToe::Game& game,
+                          TicTacToe::NetworkPlayer* player) {
+  if (game.Winner() == TicTacToe::X) {
+    return game.Turns() - 10;
+  }
+  if (game.Winner() == TicTacToe::O) {
+    return 10 - game.Turns();
+  }
+  if (game.Over()) {
+    return 0.0;
+  }
+  double score = 0.0;
+  for (const TicTacToe::Game::Position& move : game.FreeMoveRange()) {
+    TicTacToe::Game next = game;
+    next.SetTile(move, TicTacToe::X);
+    if (!next.Over()) {
+      next.SetTile(player->NextMove(next), TicTacToe::O);
+    }
+    score += TicTacToeSlowScore(next, player);
+  }
+  return score;
+}
+}
+
+TEST(MNKFitnessTest, NetworkPlayerTest) {
+  SimpleNetworkEvolver evolver =
+      ConstructEvolver(mnk::NetworkLayerSizes<ConnectFour>({}));
+  const SimpleNetwork network = evolver.InitialSpecimen();
+  mnk::NetworkPlayer<ConnectFour> player(&network);
+
+  // The network only picks legal moves.
+  ConnectFour game;
+  mnk::Player turn = mnk::O;
+  while (!game.Over()) {
+    const ConnectFour::Position move = player.NextMove(game);
+    ASSERT_TRUE(game.IsLegal(move.first, move.second));
+    game.Play(move, turn);
+    turn = (turn == mnk::X ? mnk::O : mnk::X);
+  }
+}
+
+TEST(MNKFitnessTest, ScriptedMoveTest) {
+  MNKTicTacToe game;
+  EXPECT_EQ(mnk::ScriptedMove(game, mnk::X), MNKTicTacToe::Position(1, 1));
+
+  // Blocking a line of the other player.
+  game.Play(0, 0, mnk::O);
+  game.Play(1, 1, mnk::X);
+  game.Play(1, 0, mnk::O);
+  EXPECT_EQ(mnk::ScriptedMove(game, mnk::X), MNKTicTacToe::Position(2, 0));
+
+  // Completing a line comes first.
+  game.Play(0, 1, mnk::X);
+  EXPECT_EQ(mnk::ScriptedMove(game, mnk::X), MNKTicTacToe::Position(2, 1));
+}
+
+TEST(MNKFitnessTest, FitnessTest) {
+  SimpleNetworkEvolver evolver =
+      ConstructEvolver(mnk::NetworkLayerSizes<MNKTicTacToe>({6}));
+  for (int i = 0; i < 10; ++i) {
+    const SimpleNetwork network = evolver.InitialSpecimen();
+    const double fast = mnk::FastFitness<MNKTicTacToe>(&network)();
+    EXPECT_LE(fast, 2 * 10.0);
+    EXPECT_GE(fast, 2 * -10.0);
+
+    // Without branching, X always plays ScriptedMove, as in the fast fitness.
+    EXPECT_EQ(mnk::SlowFitness<MNKTicTacToe>(&network, 0)(), fast);
+    const double slow = mnk::SlowFitness<MNKTicTacToe>(&network, 2)();
+    EXPECT_EQ(mnk::SlowFitness<MNKTicTacToe>(&network, 2)(), slow);
+  }
+}
+
+// On a 3x3 board, the fitness functions have to score like those of the
+// tic-tac-toe engine.
+TEST(MNKFitnessTest, TicTacToeTest) {
+  std::mt19937 generator(23);
+  const std::vector<int> layer_sizes =
+      mnk::NetworkLayerSizes<MNKTicTacToe>({6});
+  // SimpleNetworkSlowFitness plays on after a win until the board is full, so
+  // the slow fitness is compared with a search on the tic-tac-toe engine that
+  // stops at a win. The scripted opponents differ once the center is taken:
+  // the tic-tac-toe one takes the first free tile, ScriptedMove the one
+  // closest to the center. SimpleNetworkFastFitness therefore plays against
+  // ScriptedMove.
+  const TicTacToe::OpponentTable opponent(&MNKScriptedMove);
+  for (int i = 0; i < 10; ++i) {
+    const SimpleNetwork network =
+        simple_network_testing::RandomNetwork(layer_sizes, 0.5, &generator);
+    TicTacToe::NetworkPlayer player(&network);
+    TicTacToe::Game ai_start;
+    ai_start.SetTile(player.NextMove(ai_start), TicTacToe::O);
+    EXPECT_EQ(mnk::SlowFitness<MNKTicTacToe>(&network, 9)(),
+              TicTacToeSlowScore(TicTacToe::Game(), &player) +
+                  TicTacToeSlowScore(ai_start, &player));
+    EXPECT_EQ(mnk::FastFitness<MNKTicTacToe>(&network)(),
+              TicTacToe::SimpleNetworkFastFitness(&network, &opponent)());
+  }
+}
+
+TEST(MNKFitnessTest, ProcessTest) {
+  using SNProcess = Process<SimpleNetwork>;
+  SimpleNetworkEvolver evolver =
+      ConstructEvolver(mnk::NetworkLayerSizes<ConnectFour>({8}));
+  SNProcess::Options options;
+  options.natural_selection_strategy = SNProcess::Options::KILL_PRECISE_WORST;
+  options.generation_size = 6;
+  options.offspring_count = 4;
+  options.evolution_terminate = SNProcess::TerminateAfterNGenerations(2);
+  const auto fitness = [](const SimpleNetwork& network) {
+    return mnk::FastFitness<ConnectFour>(&network)();
+  };
+  const SNProcess::Generation generation =
+      SNProcess::Evolution(&evolver, fitness, options);
+  ASSERT_EQ(generation.size(), 6);
+  EXPECT_EQ(generation.front().LayerSize(0), ConnectFour::kInputSize);
+}
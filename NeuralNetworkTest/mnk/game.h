@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace mnk {
+
+enum Player { None = 0, X = 1, O = 2 };
+
+// An m,n,k-game: two players take turns putting stones on an M x N board and
+// the first one with K stones in a horizontal, vertical or diagonal line wins.
+// With gravity, stones fall to the lowest free tile of their column, as in
+// Connect Four. Examples are MNKGame<3, 3, 3> (tic-tac-toe),
+// MNKGame<7, 6, 4, true> (Connect Four) and MNKGame<15, 15, 5> (Gomoku).
+//
+// Each player's stones are stored as a bitboard with one column of N + 1 bits
+// per x coordinate, where the last bit of each column is always empty. This
+// padding stops lines from wrapping around when a bitboard is shifted. Playing
+// a stone only checks the lines through it and updates a Zobrist hash, so the
+// cost of a move does not depend on the board size.
+template <int M, int N, int K, bool Gravity = false>
+class MNKGame {
+ public:
+  static const int kWidth = M;
+  static const int kHeight = N;
+  static const int kLineLength = K;
+  static const bool kGravity = Gravity;
+  static const int kTiles = M * N;
+  static const int kBits = M * (N + 1);
+
+  using Position = std::pair<int, int>;
+  using Board = std::bitset<kBits>;
+
+  MNKGame() = default;
+
+  // The stone on a tile.
+  Player Tile(int x, int y) const;
+  Player Tile(const Position& xy) const { return Tile(xy.first, xy.second); }
+
+  // The stones of one player.
+  const Board& Stones(Player player) const;
+
+  // Whether a stone may be put on a tile, i.e. the tile is free and, with
+  // gravity, the lowest free tile of its column.
+  bool IsLegal(int x, int y) const;
+
+  // Puts a stone on a legal tile.
+  void Play(int x, int y, Player player);
+  void Play(const Position& xy, Player player) {
+    Play(xy.first, xy.second, player);
+  }
+
+  // Whether putting a stone on a legal tile would complete a line.
+  bool WouldWin(int x, int y, Player player) const;
+
+  // Writes all legal moves to *moves, ordered by x and then by y. The vector
+  // is cleared first, so it can be reused without allocating.
+  void LegalMoves(std::vector<Position>* moves) const;
+
+  // The first player who completed a line, or None.
+  Player Winner() const { return winner_; }
+
+  // The number of stones on the board.
+  int Turns() const { return turns_; }
+
+  // Whether a player won or the board is full.
+  bool Over() const { return winner_ != None || turns_ == kTiles; }
+
+  // A Zobrist hash of the stones on the board.
+  uint64_t Hash() const { return hash_; }
+
+  // The number of network inputs: one per tile plus a constant 1.
+  static const int kInputSize = kTiles + 1;
+  // Writes the network input of this game to kInputSize values. Tile (x, y)
+  // has index x + y * M and is -1 for X, 1 for O and 0 if free.
+  void ToNetworkInput(double* input) const;
+
+  // The output index of a tile, which equals its input index.
+  static int TileIndex(int x, int y) { return x + y * M; }
+
+  // Whether a bitboard contains a line of K stones. This checks the whole
+  // board with shifts and ANDs instead of only the lines through one tile.
+  static bool HasLine(const Board& board);
+
+ private:
+  // The position of a tile in a bitboard.
+  static int BitIndex(int x, int y) { return x * (N + 1) + y; }
+
+  // The Zobrist keys of each player and tile.
+  using ZobristTable = std::array<uint64_t, 2 * kTiles>;
+  static const ZobristTable& ZobristKeys();
+
+  // The number of consecutive stones of a board starting next to (x, y) in
+  // one direction, up to K - 1.
+  static int CountDirection(const Board& board, int x, int y, int dx, int dy);
+
+  Board x_stones_;
+  Board o_stones_;
+  // The number of stones in each column, used with gravity.
+  std::array<int, M> heights_{};
+  int turns_ = 0;
+  Player winner_ = None;
+  uint64_t hash_ = 0;
+};
+}
+
+#include "mnk/game.impl.h"
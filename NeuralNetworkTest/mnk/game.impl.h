@@ -0,0 +1,151 @@
+
+namespace mnk {
+
+template <int M, int N, int K, bool Gravity>
+const int MNKGame<M, N, K, Gravity>::kWidth;
+template <int M, int N, int K, bool Gravity>
+const int MNKGame<M, N, K, Gravity>::kHeight;
+template <int M, int N, int K, bool Gravity>
+const int MNKGame<M, N, K, Gravity>::kLineLength;
+template <int M, int N, int K, bool Gravity>
+const bool MNKGame<M, N, K, Gravity>::kGravity;
+template <int M, int N, int K, bool Gravity>
+const int MNKGame<M, N, K, Gravity>::kTiles;
+template <int M, int N, int K, bool Gravity>
+const int MNKGame<M, N, K, Gravity>::kBits;
+template <int M, int N, int K, bool Gravity>
+const int MNKGame<M, N, K, Gravity>::kInputSize;
+
+template <int M, int N, int K, bool Gravity>
+Player MNKGame<M, N, K, Gravity>::Tile(int x, int y) const {
+  const int bit = BitIndex(x, y);
+  if (x_stones_[bit]) {
+    return X;
+  }
+  return (o_stones_[bit] ? O : None);
+}
+
+template <int M, int N, int K, bool Gravity>
+const typename MNKGame<M, N, K, Gravity>::Board&
+MNKGame<M, N, K, Gravity>::Stones(Player player) const {
+  return (player == X ? x_stones_ : o_stones_);
+}
+
+template <int M, int N, int K, bool Gravity>
+bool MNKGame<M, N, K, Gravity>::IsLegal(int x, int y) const {
+  if (x < 0 || x >= M || y < 0 || y >= N || Tile(x, y) != None) {
+    return false;
+  }
+  return !Gravity || heights_[x] == y;
+}
+
+template <int M, int N, int K, bool Gravity>
+void MNKGame<M, N, K, Gravity>::Play(int x, int y, Player player) {
+  if (winner_ == None && WouldWin(x, y, player)) {
+    winner_ = player;
+  }
+  const int bit = BitIndex(x, y);
+  (player == X ? x_stones_ : o_stones_).set(bit);
+  ++heights_[x];
+  ++turns_;
+  hash_ ^= ZobristKeys()[(player == X ? 0 : kTiles) + TileIndex(x, y)];
+}
+
+template <int M, int N, int K, bool Gravity>
+bool MNKGame<M, N, K, Gravity>::WouldWin(int x, int y, Player player) const {
+  // Count the stones on both sides of the tile in each of the 4 directions.
+  const Board& board = Stones(player);
+  const int directions[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+  for (const auto& direction : directions) {
+    const int dx = direction[0], dy = direction[1];
+    if (1 + CountDirection(board, x, y, dx, dy) +
+            CountDirection(board, x, y, -dx, -dy) >=
+        K) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <int M, int N, int K, bool Gravity>
+int MNKGame<M, N, K, Gravity>::CountDirection(const Board& board, int x,
+                                              int y, int dx, int dy) {
+  int count = 0;
+  for (x += dx, y += dy; count < K - 1 && x >= 0 && x < M && y >= 0 && y < N;
+       x += dx, y += dy) {
+    if (!board[BitIndex(x, y)]) {
+      break;
+    }
+    ++count;
+  }
+  return count;
+}
+
+template <int M, int N, int K, bool Gravity>
+void MNKGame<M, N, K, Gravity>::LegalMoves(std::vector<Position>* moves) const {
+  moves->clear();
+  for (int x = 0; x < M; ++x) {
+    if (Gravity) {
+      if (heights_[x] < N) {
+        moves->emplace_back(x, heights_[x]);
+      }
+      continue;
+    }
+    for (int y = 0; y < N; ++y) {
+      if (Tile(x, y) == None) {
+        moves->emplace_back(x, y);
+      }
+    }
+  }
+}
+
+template <int M, int N, int K, bool Gravity>
+void MNKGame<M, N, K, Gravity>::ToNetworkInput(double* input) const {
+  for (int x = 0; x < M; ++x) {
+    for (int y = 0; y < N; ++y) {
+      const int bit = BitIndex(x, y);
+      input[TileIndex(x, y)] =
+          (x_stones_[bit] ? -1.0 : (o_stones_[bit] ? 1.0 : 0.0));
+    }
+  }
+  input[kTiles] = 1.0;
+}
+
+template <int M, int N, int K, bool Gravity>
+bool MNKGame<M, N, K, Gravity>::HasLine(const Board& board) {
+  // Moving one tile vertically, anti-diagonally, horizontally or diagonally
+  // moves a bit by 1, N, N + 1 or N + 2. A bit of "line" stays set as long as
+  // the tiles in that direction are set as well.
+  const int shifts[4] = {1, N, N + 1, N + 2};
+  for (const int shift : shifts) {
+    Board line = board;
+    for (int i = 1; i < K && line.any(); ++i) {
+      line &= board >> (i * shift);
+    }
+    if (line.any()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <int M, int N, int K, bool Gravity>
+const typename MNKGame<M, N, K, Gravity>::ZobristTable&
+MNKGame<M, N, K, Gravity>::ZobristKeys() {
+  // The keys are generated with splitmix64 from a fixed seed, so that hashes
+  // are the same in every run.
+  static const ZobristTable keys = [] {
+    ZobristTable result;
+    uint64_t state = 0x2545f4914f6cdd1dull;
+    for (uint64_t& key : result) {
+      state += 0x9e3779b97f4a7c15ull;
+      uint64_t value = state;
+      value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+      value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+      key = value ^ (value >> 31);
+    }
+    return result;
+  }();
+  return keys;
+}
+}
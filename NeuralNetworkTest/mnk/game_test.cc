@@ -0,0 +1,106 @@
+
+#include <random>
+
+#include "mnk/game.h"
+#include "gtest/gtest.h"
+
+namespace {
+using TicTacToe = mnk::MNKGame<3, 3, 3>;
+using ConnectFour = mnk::MNKGame<7, 6, 4, true>;
+using Gomoku = mnk::MNKGame<15, 15, 5>;
+
+// Plays random legal moves until the game is over and checks the incremental
+// win detection against HasLine after every move.
+template <typename GameT>
+void RandomGame(std::mt19937* generator) {
+  GameT game;
+  std::vector<typename GameT::Position> moves;
+  mnk::Player player = mnk::X;
+  while (!game.Over()) {
+    game.LegalMoves(&moves);
+    ASSERT_FALSE(moves.empty());
+    std::uniform_int_distribution<int> choice(0, moves.size() - 1);
+    const typename GameT::Position move = moves[choice(*generator)];
+    ASSERT_TRUE(game.IsLegal(move.first, move.second));
+    game.Play(move, player);
+    EXPECT_EQ(game.Tile(move), player);
+    EXPECT_EQ(game.Winner() == player,
+              GameT::HasLine(game.Stones(player)));
+    player = (player == mnk::X ? mnk::O : mnk::X);
+  }
+}
+}
+
+TEST(MNKGameTest, RandomGameTest) {
+  std::mt19937 generator(1);
+  for (int i = 0; i < 50; ++i) {
+    RandomGame<TicTacToe>(&generator);
+    RandomGame<ConnectFour>(&generator);
+    RandomGame<Gomoku>(&generator);
+  }
+}
+
+TEST(MNKGameTest, LineTest) {
+  // Three stones that would be a vertical line if columns were not padded.
+  TicTacToe game;
+  game.Play(0, 1, mnk::X);
+  game.Play(0, 2, mnk::X);
+  EXPECT_FALSE(game.WouldWin(1, 0, mnk::X));
+  game.Play(1, 0, mnk::X);
+  EXPECT_EQ(game.Winner(), mnk::None);
+  EXPECT_FALSE(TicTacToe::HasLine(game.Stones(mnk::X)));
+
+  // An anti-diagonal.
+  TicTacToe diagonal;
+  diagonal.Play(0, 2, mnk::O);
+  diagonal.Play(1, 1, mnk::O);
+  EXPECT_TRUE(diagonal.WouldWin(2, 0, mnk::O));
+  EXPECT_FALSE(diagonal.WouldWin(2, 0, mnk::X));
+  diagonal.Play(2, 0, mnk::O);
+  EXPECT_EQ(diagonal.Winner(), mnk::O);
+  EXPECT_TRUE(TicTacToe::HasLine(diagonal.Stones(mnk::O)));
+}
+
+TEST(MNKGameTest, GravityTest) {
+  ConnectFour game;
+  EXPECT_TRUE(game.IsLegal(3, 0));
+  EXPECT_FALSE(game.IsLegal(3, 1));
+  game.Play(3, 0, mnk::X);
+  EXPECT_TRUE(game.IsLegal(3, 1));
+
+  std::vector<ConnectFour::Position> moves;
+  game.LegalMoves(&moves);
+  EXPECT_EQ(moves.size(), 7);
+  EXPECT_EQ(moves[3], ConnectFour::Position(3, 1));
+}
+
+TEST(MNKGameTest, HashTest) {
+  // The hash only depends on the stones, not on the order of the moves.
+  Gomoku a, b;
+  a.Play(1, 2, mnk::X);
+  a.Play(7, 7, mnk::O);
+  a.Play(3, 4, mnk::X);
+  b.Play(3, 4, mnk::X);
+  b.Play(7, 7, mnk::O);
+  b.Play(1, 2, mnk::X);
+  EXPECT_EQ(a.Hash(), b.Hash());
+  EXPECT_NE(a.Hash(), Gomoku().Hash());
+
+  Gomoku c;
+  c.Play(1, 2, mnk::O);
+  c.Play(7, 7, mnk::X);
+  c.Play(3, 4, mnk::O);
+  EXPECT_NE(a.Hash(), c.Hash());
+}
+
+TEST(MNKGameTest, NetworkInputTest) {
+  ConnectFour game;
+  game.Play(2, 0, mnk::X);
+  game.Play(2, 1, mnk::O);
+  std::vector<double> input(ConnectFour::kInputSize);
+  game.ToNetworkInput(input.data());
+  EXPECT_EQ(input[ConnectFour::TileIndex(2, 0)], -1.0);
+  EXPECT_EQ(input[ConnectFour::TileIndex(2, 1)], 1.0);
+  EXPECT_EQ(input[ConnectFour::TileIndex(0, 0)], 0.0);
+  EXPECT_EQ(input.back(), 1.0);
+}
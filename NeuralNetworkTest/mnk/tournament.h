@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "mnk/fitness.h"
+#include "mnk/game.h"
+#include "nn/simple_network.h"
+#include "util/concurrency/thread_pool.h"
+
+namespace mnk {
+
+// Scores the networks of a generation by letting them play against each other,
+// once as X and once as O for each pairing. The score of a network is its
+// average EndedGameScore from its own point of view, so generations can be
+// scored with Process::Options::batch_fitness_function.
+//
+// Two networks always play the same game, so results are cached by the pair of
+// their SimpleNetwork::Hash. Identical networks in a generation and survivors
+// of earlier generations therefore do not replay their games. The games that
+// are not cached are played in parallel on a thread pool.
+template <typename GameT>
+class Tournament {
+ public:
+  struct Options {
+    // The number of opponents that each network picks at random, or 0 to let
+    // every network play against every other one. Networks also play against
+    // those that picked them, so they play at least 2 * opponents games.
+    int opponents = 0;
+
+    // The seed of the random generator that picks the opponents. It is
+    // advanced with each generation.
+    unsigned int seed = 0;
+
+    // The pool that plays the games, or nullptr for ThreadPool::Default().
+    util::concurrency::ThreadPool* thread_pool = nullptr;
+
+    // The number of game results that are kept between generations. It is
+    // rounded up to a power of two.
+    unsigned int cache_capacity = 1 << 16;
+  };
+
+  explicit Tournament(const Options& options);
+
+  // Writes the score of each network to *scores. GenerationT is e.g.
+  // std::vector<SimpleNetwork>.
+  template <typename GenerationT>
+  void operator()(const GenerationT& networks, std::vector<double>* scores);
+
+  // The number of games that were found in the cache and that were played.
+  unsigned int hits() const { return hits_; }
+  unsigned int misses() const { return misses_; }
+
+ private:
+  // A game between two networks, identified by their hashes.
+  struct Pairing {
+    std::size_t x_hash;
+    std::size_t o_hash;
+
+    bool operator==(const Pairing& other) const {
+      return x_hash == other.x_hash && o_hash == other.o_hash;
+    }
+  };
+
+  struct PairingHash {
+    std::size_t operator()(const Pairing& pairing) const {
+      return pairing.x_hash * 0x9e3779b97f4a7c15ull ^ pairing.o_hash;
+    }
+  };
+
+  // A cached game result.
+  struct Entry {
+    Pairing pairing;
+    double score = 0.0;
+    bool valid = false;
+  };
+
+  // A distinct game of the current generation, played by the networks with
+  // the given indices.
+  struct Game {
+    Pairing pairing;
+    unsigned int x;
+    unsigned int o;
+    double score;
+  };
+
+  // A scheduled game of two networks; equal games share their result.
+  struct Match {
+    unsigned int x;
+    unsigned int o;
+    unsigned int game;
+  };
+
+  // Plays a game between two networks and returns its EndedGameScore.
+  static double Play(NetworkPlayer<GameT>* x_player,
+                     NetworkPlayer<GameT>* o_player);
+
+  // Schedules the games of two networks, once in each color.
+  void AddPairing(const std::vector<std::size_t>& hashes, unsigned int a,
+                  unsigned int b);
+
+  // Plays the games with the given indices in parallel and writes their
+  // scores to games_.
+  template <typename GenerationT>
+  void PlayGames(const GenerationT& networks,
+                 const std::vector<unsigned int>& game_indices);
+
+  // The cache slot of a pairing.
+  Entry& Slot(const Pairing& pairing);
+
+  Options options_;
+  std::mt19937 generator_;
+  std::vector<Entry> cache_;
+
+  // The schedule of the current generation.
+  std::vector<Game> games_;
+  std::vector<Match> matches_;
+  std::unordered_map<Pairing, unsigned int, PairingHash> game_indices_;
+
+  unsigned int hits_ = 0;
+  unsigned int misses_ = 0;
+};
+}
+
+#include "mnk/tournament.impl.h"
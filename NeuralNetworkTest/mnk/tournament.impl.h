@@ -0,0 +1,155 @@
+
+#include <algorithm>
+#include <numeric>
+
+namespace mnk {
+
+template <typename GameT>
+Tournament<GameT>::Tournament(const Options& options)
+    : options_(options), generator_(options.seed) {
+  unsigned int capacity = 1;
+  while (capacity < options_.cache_capacity) {
+    capacity *= 2;
+  }
+  cache_.resize(capacity);
+}
+
+template <typename GameT>
+template <typename GenerationT>
+void Tournament<GameT>::operator()(const GenerationT& networks,
+                                   std::vector<double>* scores) {
+  const unsigned int size = networks.size();
+  std::vector<std::size_t> hashes(size);
+  for (unsigned int i = 0; i < size; ++i) {
+    hashes[i] = networks[i].Hash();
+  }
+
+  // Schedule the games.
+  games_.clear();
+  matches_.clear();
+  game_indices_.clear();
+  if (options_.opponents <= 0 ||
+      static_cast<unsigned int>(options_.opponents) + 1 >= size) {
+    for (unsigned int a = 0; a < size; ++a) {
+      for (unsigned int b = a + 1; b < size; ++b) {
+        AddPairing(hashes, a, b);
+      }
+    }
+  } else {
+    // Pick the opponents with a partial Fisher-Yates shuffle of the other
+    // networks.
+    std::vector<unsigned int> others(size - 1);
+    for (unsigned int a = 0; a < size; ++a) {
+      std::iota(others.begin(), others.begin() + a, 0);
+      std::iota(others.begin() + a, others.end(), a + 1);
+      for (int i = 0; i < options_.opponents; ++i) {
+        std::uniform_int_distribution<int> distribution(i, size - 2);
+        std::swap(others[i], others[distribution(generator_)]);
+        AddPairing(hashes, a, others[i]);
+      }
+    }
+  }
+
+  // Take the known results from the cache and play the other games.
+  std::vector<unsigned int> missing;
+  for (unsigned int i = 0; i < games_.size(); ++i) {
+    const Entry& entry = Slot(games_[i].pairing);
+    if (entry.valid && entry.pairing == games_[i].pairing) {
+      games_[i].score = entry.score;
+      ++hits_;
+    } else {
+      missing.push_back(i);
+      ++misses_;
+    }
+  }
+  PlayGames(networks, missing);
+  for (const unsigned int i : missing) {
+    Entry& entry = Slot(games_[i].pairing);
+    entry.pairing = games_[i].pairing;
+    entry.score = games_[i].score;
+    entry.valid = true;
+  }
+
+  // The scores are from the point of view of O.
+  scores->assign(size, 0.0);
+  std::vector<int> game_counts(size, 0);
+  for (const Match& match : matches_) {
+    const double score = games_[match.game].score;
+    (*scores)[match.x] -= score;
+    (*scores)[match.o] += score;
+    ++game_counts[match.x];
+    ++game_counts[match.o];
+  }
+  for (unsigned int i = 0; i < size; ++i) {
+    if (game_counts[i] > 0) {
+      (*scores)[i] /= game_counts[i];
+    }
+  }
+}
+
+template <typename GameT>
+double Tournament<GameT>::Play(NetworkPlayer<GameT>* x_player,
+                               NetworkPlayer<GameT>* o_player) {
+  GameT game;
+  Player player = X;
+  while (!game.Over()) {
+    NetworkPlayer<GameT>* current = (player == X ? x_player : o_player);
+    game.Play(current->NextMove(game, player), player);
+    player = (player == X ? O : X);
+  }
+  return EndedGameScore(game);
+}
+
+template <typename GameT>
+void Tournament<GameT>::AddPairing(const std::vector<std::size_t>& hashes,
+                                   unsigned int a, unsigned int b) {
+  for (int color = 0; color < 2; ++color) {
+    const unsigned int x = (color == 0 ? a : b);
+    const unsigned int o = (color == 0 ? b : a);
+    const Pairing pairing{hashes[x], hashes[o]};
+    const auto inserted = game_indices_.emplace(pairing, games_.size());
+    if (inserted.second) {
+      games_.push_back(Game{pairing, x, o, 0.0});
+    }
+    matches_.push_back(Match{x, o, inserted.first->second});
+  }
+}
+
+template <typename GameT>
+template <typename GenerationT>
+void Tournament<GameT>::PlayGames(
+    const GenerationT& networks,
+    const std::vector<unsigned int>& game_indices) {
+  if (game_indices.empty()) {
+    return;
+  }
+
+  // Compiling is not thread-safe, so all networks are compiled up front.
+  for (unsigned int i = 0; i < networks.size(); ++i) {
+    if (!networks[i].IsCompiled()) {
+      networks[i].Compile();
+    }
+  }
+
+  // Games take very different times, so they are distributed by work
+  // stealing. The players are reused by all games on a thread.
+  const auto play_game = [this, &networks, &game_indices](int i) {
+    thread_local NetworkPlayer<GameT> x_player(&networks[0]);
+    thread_local NetworkPlayer<GameT> o_player(&networks[0]);
+    Game& game = games_[game_indices[i]];
+    x_player.SetNetwork(&networks[game.x]);
+    o_player.SetNetwork(&networks[game.o]);
+    game.score = Play(&x_player, &o_player);
+  };
+  util::concurrency::ThreadPool* pool =
+      (options_.thread_pool ? options_.thread_pool
+                            : util::concurrency::ThreadPool::Default());
+  util::concurrency::ParallelFor(pool, 0, game_indices.size(), 16, play_game);
+}
+
+template <typename GameT>
+typename Tournament<GameT>::Entry& Tournament<GameT>::Slot(
+    const Pairing& pairing) {
+  return cache_[PairingHash()(pairing) & (cache_.size() - 1)];
+}
+}
@@ -0,0 +1,97 @@
+
+#include "mnk/tournament.h"
+#include "nn/simple_network_evolver.h"
+#include "gtest/gtest.h"
+
+namespace {
+using TicTacToe = mnk::MNKGame<3, 3, 3>;
+
+std::vector<SimpleNetwork> RandomNetworks(int count) {
+  SimpleNetworkEvolver::Options options;
+  options.layer_sizes = mnk::NetworkLayerSizes<TicTacToe>({6});
+  options.mutation_grow_chance = 0.5;
+  options.mutation_weight_chance = 0.5;
+  SimpleNetworkEvolver evolver(options);
+  std::vector<SimpleNetwork> networks;
+  for (int i = 0; i < count; ++i) {
+    networks.push_back(evolver.InitialSpecimen());
+  }
+  return networks;
+}
+
+// Plays a game without the tournament.
+double GameScore(const SimpleNetwork& x, const SimpleNetwork& o) {
+  mnk::NetworkPlayer<TicTacToe> x_player(&x);
+  mnk::NetworkPlayer<TicTacToe> o_player(&o);
+  TicTacToe game;
+  mnk::Player player = mnk::X;
+  while (!game.Over()) {
+    game.Play((player == mnk::X ? x_player : o_player).NextMove(game, player),
+              player);
+    player = (player == mnk::X ? mnk::O : mnk::X);
+  }
+  return mnk::EndedGameScore(game);
+}
+}
+
+TEST(TournamentTest, RoundRobinTest) {
+  const std::vector<SimpleNetwork> networks = RandomNetworks(6);
+  std::vector<double> expected(networks.size(), 0.0);
+  for (unsigned int x = 0; x < networks.size(); ++x) {
+    for (unsigned int o = 0; o < networks.size(); ++o) {
+      if (x != o) {
+        const double score = GameScore(networks[x], networks[o]);
+        expected[x] -= score / (2 * (networks.size() - 1));
+        expected[o] += score / (2 * (networks.size() - 1));
+      }
+    }
+  }
+
+  util::concurrency::ThreadPool pool(3);
+  mnk::Tournament<TicTacToe>::Options options;
+  options.thread_pool = &pool;
+  mnk::Tournament<TicTacToe> tournament(options);
+  std::vector<double> scores;
+  tournament(networks, &scores);
+  ASSERT_EQ(scores.size(), networks.size());
+  for (unsigned int i = 0; i < networks.size(); ++i) {
+    EXPECT_NEAR(scores[i], expected[i], 1e-9);
+  }
+  EXPECT_EQ(tournament.hits(), 0);
+  EXPECT_EQ(tournament.misses(), 30);
+
+  // The second time, all results are cached.
+  std::vector<double> cached_scores;
+  tournament(networks, &cached_scores);
+  EXPECT_EQ(cached_scores, scores);
+  EXPECT_EQ(tournament.hits(), 30);
+  EXPECT_EQ(tournament.misses(), 30);
+}
+
+TEST(TournamentTest, DuplicateTest) {
+  // Copies of a network play the same games, which are only played once: A
+  // against B, B against A and A against its copy.
+  std::vector<SimpleNetwork> networks = RandomNetworks(2);
+  networks.push_back(networks[0]);
+  mnk::Tournament<TicTacToe> tournament({});
+  std::vector<double> scores;
+  tournament(networks, &scores);
+  EXPECT_EQ(tournament.misses(), 3);
+  EXPECT_NEAR(scores[0] + scores[1] + scores[2], 0.0, 1e-9);
+}
+
+TEST(TournamentTest, SampledTest) {
+  const std::vector<SimpleNetwork> networks = RandomNetworks(20);
+  mnk::Tournament<TicTacToe>::Options options;
+  options.opponents = 3;
+  options.seed = 7;
+  mnk::Tournament<TicTacToe> tournament(options);
+  std::vector<double> scores;
+  tournament(networks, &scores);
+  ASSERT_EQ(scores.size(), networks.size());
+  EXPECT_LE(tournament.misses(), 20 * 3 * 2);
+  for (const double score : scores) {
+    EXPECT_LE(score, 10.0);
+    EXPECT_GE(score, -10.0);
+  }
+}
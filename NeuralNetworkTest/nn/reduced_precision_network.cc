@@ -0,0 +1,218 @@
+
+#include <algorithm>
+#include <cmath>
+
+#include "nn/reduced_precision_network.h"
+#include "snowhouse/snowhouse.h"
+
+using namespace snowhouse;
+
+namespace {
+// The number of values the dot product kernels process at once. Keeping a
+// separate partial sum per lane lets the compiler map the loops onto SIMD
+// registers without having to reorder floating point additions.
+const unsigned int kLanes = 16;
+
+unsigned int RoundUpToLanes(unsigned int size) {
+  return (size + kLanes - 1) / kLanes * kLanes;
+}
+
+// Dot products of two arrays whose length is a multiple of kLanes.
+float DotFloat32(const float* lhs, const float* rhs, unsigned int size) {
+  float sums[kLanes] = {};
+  for (unsigned int i = 0; i < size; i += kLanes) {
+    for (unsigned int lane = 0; lane < kLanes; ++lane) {
+      sums[lane] += lhs[i + lane] * rhs[i + lane];
+    }
+  }
+  float sum = 0.0f;
+  for (unsigned int lane = 0; lane < kLanes; ++lane) {
+    sum += sums[lane];
+  }
+  return sum;
+}
+
+int32_t DotInt8(const int8_t* lhs, const int8_t* rhs, unsigned int size) {
+  int32_t sums[kLanes] = {};
+  for (unsigned int i = 0; i < size; i += kLanes) {
+    for (unsigned int lane = 0; lane < kLanes; ++lane) {
+      sums[lane] += lhs[i + lane] * rhs[i + lane];
+    }
+  }
+  int32_t sum = 0;
+  for (unsigned int lane = 0; lane < kLanes; ++lane) {
+    sum += sums[lane];
+  }
+  return sum;
+}
+
+// Converts a value to int8 with the given inverse scale.
+int8_t Quantize(float value, float inverse_scale) {
+  return static_cast<int8_t>(std::lround(value * inverse_scale));
+}
+}
+
+ReducedPrecisionNetwork::ReducedPrecisionNetwork(const SimpleNetwork& network,
+                                                 Precision precision)
+    : precision_(precision),
+      activation_function_(network.activation_function) {
+  for (unsigned int i = 0; i + 1 < network.LayerNumber(); ++i) {
+    Layer layer;
+    layer.size = network.LayerSize(i);
+    layer.next_size = network.LayerSize(i + 1);
+    layer.padded_size = RoundUpToLanes(layer.size);
+    layer.scale = 1.0f;
+
+    // Collect the weights in the transposed, padded layout.
+    std::vector<float> weights(layer.padded_size * layer.next_size, 0.0f);
+    for (unsigned int to = 0; to < layer.next_size; ++to) {
+      for (unsigned int from = 0; from < layer.size; ++from) {
+        const SimpleNetwork::Edge edge(i, from, to);
+        if (network.HasConnection(edge)) {
+          weights[from + to * layer.padded_size] =
+              network.ConnectionWeight(edge);
+        }
+      }
+    }
+
+    if (precision_ == FLOAT32) {
+      layer.float_weights = std::move(weights);
+    } else {
+      // Use the full int8 range for the largest weight of the layer.
+      float max_weight = 0.0f;
+      for (float weight : weights) {
+        max_weight = std::max(max_weight, std::abs(weight));
+      }
+      layer.scale = (max_weight > 0.0f ? max_weight / 127.0f : 1.0f);
+      for (float weight : weights) {
+        layer.int8_weights.push_back(Quantize(weight, 1.0f / layer.scale));
+      }
+    }
+    layers_.push_back(std::move(layer));
+  }
+}
+
+ReducedPrecisionNetwork::Precision ReducedPrecisionNetwork::precision() const {
+  return precision_;
+}
+
+unsigned int ReducedPrecisionNetwork::LayerNumber() const {
+  return layers_.size() + 1;
+}
+
+unsigned int ReducedPrecisionNetwork::LayerSize(unsigned int layer) const {
+  try {
+    AssertThat(layer, IsLessThan(LayerNumber()));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  if (layer + 1 == LayerNumber()) {
+    return layers_.back().next_size;
+  } else {
+    return layers_[layer].size;
+  }
+}
+
+size_t ReducedPrecisionNetwork::WeightBytes() const {
+  size_t result = 0;
+  for (const Layer& layer : layers_) {
+    result += layer.float_weights.size() * sizeof(float) +
+              layer.int8_weights.size() * sizeof(int8_t);
+  }
+  return result;
+}
+
+std::vector<float> ReducedPrecisionNetwork::Forward(
+    const std::vector<float>& input) const {
+  try {
+    AssertThat(input.size(), Equals(LayerSize(0)));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  Workspace workspace(*this);
+  std::vector<float> result(LayerSize(LayerNumber() - 1));
+  Forward(input.data(), result.data(), &workspace);
+  return result;
+}
+
+void ReducedPrecisionNetwork::Forward(const float* input, float* output,
+                                      Workspace* workspace) const {
+  // The kernels read whole lanes, so the input is copied to a padded buffer.
+  float* const buffers[2] = {workspace->front_.data(),
+                             workspace->back_.data()};
+  std::copy(input, input + layers_.front().size, buffers[1]);
+  std::fill(buffers[1] + layers_.front().size,
+            buffers[1] + layers_.front().padded_size, 0.0f);
+
+  const float* layer_values = buffers[1];
+  for (unsigned int i = 0; i < layers_.size(); ++i) {
+    const Layer& layer = layers_[i];
+    float* const next_values =
+        (i + 1 == layers_.size() ? output : buffers[i % 2]);
+    if (precision_ == FLOAT32) {
+      ForwardOneLayerFloat32(layer_values, layer, next_values);
+    } else {
+      ForwardOneLayerInt8(layer_values, layer, next_values, workspace);
+    }
+
+    // Clear the padding for the next layer.
+    if (i + 1 < layers_.size()) {
+      std::fill(next_values + layer.next_size,
+                next_values + layers_[i + 1].padded_size, 0.0f);
+    }
+    layer_values = next_values;
+  }
+}
+
+void ReducedPrecisionNetwork::ForwardOneLayerFloat32(const float* input,
+                                                     const Layer& layer,
+                                                     float* output) const {
+  for (unsigned int to = 0; to < layer.next_size; ++to) {
+    const float sum =
+        DotFloat32(input, layer.float_weights.data() + to * layer.padded_size,
+                   layer.padded_size);
+    output[to] = activation_function_(sum);
+  }
+}
+
+void ReducedPrecisionNetwork::ForwardOneLayerInt8(const float* input,
+                                                  const Layer& layer,
+                                                  float* output,
+                                                  Workspace* workspace) const {
+  // Quantise the node values with the full int8 range for the largest one.
+  float max_value = 0.0f;
+  for (unsigned int from = 0; from < layer.size; ++from) {
+    max_value = std::max(max_value, std::abs(input[from]));
+  }
+  const float value_scale = (max_value > 0.0f ? max_value / 127.0f : 1.0f);
+  int8_t* const quantized = workspace->quantized_.data();
+  for (unsigned int from = 0; from < layer.padded_size; ++from) {
+    quantized[from] = Quantize(input[from], 1.0f / value_scale);
+  }
+
+  const float scale = value_scale * layer.scale;
+  for (unsigned int to = 0; to < layer.next_size; ++to) {
+    const int32_t sum =
+        DotInt8(quantized, layer.int8_weights.data() + to * layer.padded_size,
+                layer.padded_size);
+    output[to] = activation_function_(sum * scale);
+  }
+}
+
+ReducedPrecisionNetwork::Workspace::Workspace(
+    const ReducedPrecisionNetwork& network) {
+  unsigned int max_size = 0;
+  for (const Layer& layer : network.layers_) {
+    max_size = std::max(max_size, std::max(layer.padded_size,
+                                           RoundUpToLanes(layer.next_size)));
+  }
+  front_.assign(max_size, 0.0f);
+  back_.assign(max_size, 0.0f);
+  quantized_.assign(max_size, 0);
+}
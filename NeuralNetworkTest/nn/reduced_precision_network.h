@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "nn/simple_network.h"
+
+// A read-only copy of a SimpleNetwork which runs inference in reduced
+// precision. The evolver keeps working on the double precision network; this
+// copy is made once before a network is evaluated many times, e.g. for a
+// fitness computation.
+class ReducedPrecisionNetwork {
+ public:
+  enum Precision {
+    // Weights and node values are stored as 32 bit floats.
+    FLOAT32 = 0,
+    // Weights are quantised to 8 bit integers with one scale per layer. The
+    // node values of each layer are quantised on the fly, so the products can
+    // be summed up in 32 bit integers.
+    INT8 = 1
+  };
+
+  // Scratch memory for Forward, analogous to SimpleNetwork::Workspace.
+  class Workspace {
+   public:
+    Workspace() = default;
+    explicit Workspace(const ReducedPrecisionNetwork& network);
+
+   private:
+    friend class ReducedPrecisionNetwork;
+
+    // The values of the layers alternate between these two buffers.
+    std::vector<float> front_;
+    std::vector<float> back_;
+
+    // The quantised values of the current layer in INT8 mode.
+    std::vector<int8_t> quantized_;
+  };
+
+  // Converts the network to the given precision.
+  ReducedPrecisionNetwork(const SimpleNetwork& network, Precision precision);
+
+  Precision precision() const;
+
+  // Same as in SimpleNetwork.
+  unsigned int LayerNumber() const;
+  unsigned int LayerSize(unsigned int layer) const;
+
+  // Returns the number of bytes used to store the weights, including padding.
+  size_t WeightBytes() const;
+
+  // Runs the network on some input without allocating memory. The sizes of the
+  // arrays are the same as for SimpleNetwork::Forward.
+  void Forward(const float* input, float* output, Workspace* workspace) const;
+  std::vector<float> Forward(const std::vector<float>& input) const;
+
+ private:
+  struct Layer {
+    unsigned int size;
+    unsigned int next_size;
+
+    // The size rounded up to a multiple of the SIMD lane count. The weights
+    // are stored row by row, one row of padded_size incoming weights per node
+    // on the next layer, so each output is one contiguous dot product. The
+    // padding weights are 0.
+    unsigned int padded_size;
+
+    // Only the vector for the precision of the network is filled.
+    std::vector<float> float_weights;
+    std::vector<int8_t> int8_weights;
+
+    // INT8 only: the real weight is int8_weights[i] * scale.
+    float scale;
+  };
+
+  // Propagates data of one layer to the next. The input has padded_size values
+  // and its padding is 0.
+  void ForwardOneLayerFloat32(const float* input, const Layer& layer,
+                              float* output) const;
+  void ForwardOneLayerInt8(const float* input, const Layer& layer,
+                           float* output, Workspace* workspace) const;
+
+  Precision precision_;
+  std::vector<Layer> layers_;
+  std::function<double(double)> activation_function_;
+};
@@ -0,0 +1,43 @@
+#include "nn/reduced_precision_network.h"
+
+#include <random>
+
+#include "gtest/gtest.h"
+#include "nn/simple_network_testing.h"
+
+TEST(ReducedPrecisionNetworkTest, Float32ForwardTest) {
+  SimpleNetwork network(std::vector<int>{2, 1});
+  network.AddConnection(SimpleNetwork::Edge(0, 0, 0), 0.5);
+  network.AddConnection(SimpleNetwork::Edge(0, 1, 0), -0.5);
+  network.activation_function = [](double x) { return x * 2; };
+  const ReducedPrecisionNetwork reduced_network(
+      network, ReducedPrecisionNetwork::FLOAT32);
+  ASSERT_EQ(reduced_network.LayerNumber(), 2);
+  EXPECT_EQ(reduced_network.LayerSize(0), 2);
+  EXPECT_EQ(reduced_network.LayerSize(1), 1);
+  const std::vector<float> output =
+      reduced_network.Forward(std::vector<float>{0.4f, 0.7f});
+  ASSERT_EQ(output.size(), 1);
+  EXPECT_FLOAT_EQ(output[0], 0.4f - 0.7f);
+}
+
+TEST(ReducedPrecisionNetworkTest, WeightBytesTest) {
+  // Every layer gets one row of weights per node on the next layer, padded to
+  // 16 weights per row. The connections do not matter.
+  std::mt19937 generator(1);
+  const SimpleNetwork network = simple_network_testing::RandomNetwork(
+      {10, 12, 12, 9}, 0.4, &generator);
+  const unsigned int weight_number = 16 * 12 + 16 * 12 + 16 * 9;
+  EXPECT_EQ(ReducedPrecisionNetwork(network, ReducedPrecisionNetwork::FLOAT32)
+                .WeightBytes(),
+            4 * weight_number);
+  EXPECT_EQ(ReducedPrecisionNetwork(network, ReducedPrecisionNetwork::INT8)
+                .WeightBytes(),
+            weight_number);
+
+  const SimpleNetwork wide_network(std::vector<int>{20, 3});
+  EXPECT_EQ(
+      ReducedPrecisionNetwork(wide_network, ReducedPrecisionNetwork::FLOAT32)
+          .WeightBytes(),
+      4 * 32 * 3);
+}
@@ -1,10 +1,72 @@
 
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
 #include "nn/simple_network.h"
 #include "snowhouse/snowhouse.h"
 
 using namespace snowhouse;
 
-SimpleNetwork::SimpleNetwork(const std::vector<int>& layer_sizes) {
+// One step of a compiled plan, going from the live nodes of one layer to the
+// live nodes of the next. Live nodes are those with a path to the output; the
+// nodes of the output layer are always kept.
+struct SimpleNetwork::CompiledLayer {
+  // For each live source node, the index of its value in the values of the
+  // previous step (or in the network input for the first step).
+  std::vector<unsigned int> sources;
+
+  // Whether each target node has no path from the input, and its value if so.
+  // Such nodes are computed once by Compile; the other ones sum their inputs
+  // in the same order as the uncompiled network.
+  std::vector<bool> constant;
+  std::vector<double> constant_values;
+
+  // Whether the weights are stored as a dense block. The block is column-major
+  // with one column of sources.size() weights per target. Otherwise the edges
+  // of target t are edge_sources/edge_weights[edge_offsets[t], ...[t + 1]).
+  bool dense = false;
+  std::vector<double> weights;
+  std::vector<unsigned int> edge_offsets;
+  std::vector<unsigned int> edge_sources;
+  std::vector<double> edge_weights;
+
+  // Only for the first step: the weights from each input node to each target
+  // in row-major order, so that sparse inputs only read their own rows.
+  std::vector<double> input_rows;
+};
+
+struct SimpleNetwork::CompiledPlan {
+  std::vector<CompiledLayer> layers;
+};
+
+namespace {
+
+// Allocates a copy of a shared block in the given arena.
+template <typename T>
+std::shared_ptr<T> CopyBlock(const T& block, ::util::memory::Arena* arena) {
+  return std::allocate_shared<T>(::util::memory::ArenaAllocator<T>(arena),
+                                 block, arena);
+}
+
+// Shares a block if it is stored in the given arena and copies it otherwise.
+template <typename T>
+std::shared_ptr<T> ShareOrCopyBlock(const std::shared_ptr<T>& block,
+                                    ::util::memory::Arena* arena) {
+  return (block->arena() == arena ? block : CopyBlock(*block, arena));
+}
+
+// Mixes a value into a hash.
+std::size_t HashCombine(std::size_t hash, uint64_t value) {
+  uint64_t mixed = (hash ^ value) * 0x9e3779b97f4a7c15ull;
+  mixed ^= mixed >> 32;
+  return static_cast<std::size_t>(mixed);
+}
+}
+
+SimpleNetwork::SimpleNetwork(const std::vector<int>& layer_sizes,
+                             ::util::memory::Arena* arena)
+    : layers_(arena), layer_edge_offsets_(arena) {
   try {
     AssertThat(layer_sizes.size(), IsGreaterThan(1u));
   } catch (const AssertionException& ex) {
@@ -15,11 +77,56 @@ SimpleNetwork::SimpleNetwork(const std::vector<int>& layer_sizes) {
 
   const auto begin_iter = layer_sizes.cbegin();
   const auto end_iter = std::prev(layer_sizes.cend());
+  layers_.reserve(layer_sizes.size() - 1);
+  layer_edge_offsets_.reserve(layer_sizes.size());
+  layer_edge_offsets_.push_back(0);
   for (auto iter = begin_iter; iter != end_iter; ++iter) {
-    layers_.emplace_back(*iter, *std::next(iter));
+    layers_.push_back(std::allocate_shared<Layer>(
+        ::util::memory::ArenaAllocator<Layer>(arena), *iter, *std::next(iter),
+        arena));
+    layer_edge_offsets_.push_back(
+        layer_edge_offsets_.back() +
+        layers_.back()->EdgeNumber());
+  }
+
+  // Initially all edges are missing.
+  edge_order_ = std::allocate_shared<EdgeOrder>(
+      ::util::memory::ArenaAllocator<EdgeOrder>(arena), arena);
+  edge_order_->order.resize(layer_edge_offsets_.back());
+  std::iota(edge_order_->order.begin(), edge_order_->order.end(), 0);
+  edge_order_->positions.assign(edge_order_->order.begin(),
+                                edge_order_->order.end());
+}
+
+SimpleNetwork::SimpleNetwork(const SimpleNetwork& other,
+                             ::util::memory::Arena* arena)
+    : activation_function(other.activation_function),
+      layers_(arena),
+      layer_edge_offsets_(other.layer_edge_offsets_.begin(),
+                          other.layer_edge_offsets_.end(), arena),
+      edge_order_(ShareOrCopyBlock(other.edge_order_, arena)),
+      compiled_plan_(other.compiled_plan_) {
+  layers_.reserve(other.layers_.size());
+  for (const std::shared_ptr<Layer>& layer : other.layers_) {
+    layers_.push_back(ShareOrCopyBlock(layer, arena));
   }
 }
 
+SimpleNetwork::SimpleNetwork(const SimpleNetwork& other)
+    : SimpleNetwork(other, nullptr) {}
+
+SimpleNetwork& SimpleNetwork::operator=(const SimpleNetwork& other) {
+  // Keep the arena of this network, like the containers do.
+  if (this != &other) {
+    *this = SimpleNetwork(other, arena());
+  }
+  return *this;
+}
+
+::util::memory::Arena* SimpleNetwork::arena() const {
+  return layers_.get_allocator().arena();
+}
+
 unsigned int SimpleNetwork::LayerNumber() const { return layers_.size() + 1; }
 
 unsigned int SimpleNetwork::LayerSize(unsigned int layer) const {
@@ -32,21 +139,22 @@ unsigned int SimpleNetwork::LayerSize(unsigned int layer) const {
   }
 
   if (layer + 1 == LayerNumber()) {
-    return layers_.back().connectivity_matrix.n_cols;
+    return layers_.back()->weight_matrix.cols;
   } else {
-    return layers_[layer].connectivity_matrix.n_rows;
+    return layers_[layer]->weight_matrix.rows;
   }
 }
 
 bool SimpleNetwork::HasConnection(const Edge& edge) const {
   AssertEdgeIsValid(edge);
-  const Layer& layer = layers_[edge.from.layer];
-  return !!(layer.connectivity_matrix(edge.from.index, edge.to.index));
+  const Layer& layer = *layers_[edge.from.layer];
+  return layer.HasEdge(edge.from.index +
+                       edge.to.index * layer.weight_matrix.rows);
 }
 
 double SimpleNetwork::ConnectionWeight(const Edge& edge) const {
   AssertEdgeIsValid(edge);
-  const Layer& layer = layers_[edge.from.layer];
+  const Layer& layer = *layers_[edge.from.layer];
   return layer.weight_matrix(edge.from.index, edge.to.index);
 }
 
@@ -60,18 +168,326 @@ void SimpleNetwork::AddConnection(const Edge& edge) {
 
 void SimpleNetwork::AddConnection(const Edge& edge, double weight) {
   AssertEdgeIsValid(edge);
-  Layer& layer = layers_[edge.from.layer];
-  layer.connectivity_matrix(edge.from.index, edge.to.index) = true;
+  Layer& layer = MutableLayer(edge.from.layer);
+  compiled_plan_.reset();
+  UpdateEdgeOrder(EdgeIndex(edge), true);
+  layer.SetEdge(edge.from.index + edge.to.index * layer.weight_matrix.rows,
+                true);
   layer.weight_matrix(edge.from.index, edge.to.index) = weight;
 }
 
 void SimpleNetwork::RemoveConnection(const Edge& edge) {
   AssertEdgeIsValid(edge);
-  Layer& layer = layers_[edge.from.layer];
-  layer.connectivity_matrix(edge.from.index, edge.to.index) = false;
+  Layer& layer = MutableLayer(edge.from.layer);
+  compiled_plan_.reset();
+  UpdateEdgeOrder(EdgeIndex(edge), false);
+  layer.SetEdge(edge.from.index + edge.to.index * layer.weight_matrix.rows,
+                false);
   layer.weight_matrix(edge.from.index, edge.to.index) = 0.0;
 }
 
+void SimpleNetwork::InheritLayer(unsigned int layer_index,
+                                 const SimpleNetwork& father,
+                                 const SimpleNetwork& mother,
+                                 const std::vector<uint32_t>& mask) {
+  AssertSameShape(father);
+  AssertSameShape(mother);
+  try {
+    AssertThat(layer_index, IsLessThan(layers_.size()));
+    AssertThat(mask.size(),
+               IsGreaterThanOrEqualTo(
+                   (layers_[layer_index]->EdgeNumber() + 31) / 32));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  compiled_plan_.reset();
+  const unsigned int offset = layer_edge_offsets_[layer_index];
+  const unsigned int edge_number = layers_[layer_index]->EdgeNumber();
+  const unsigned int word_number = layers_[layer_index]->connectivity.size();
+
+  // The mask with 64 bits per word, like the connectivity. The unused bits of
+  // the last word are cleared, so that they select the mother's zero bits.
+  const auto mask_word = [&mask, edge_number](unsigned int word) {
+    uint64_t result = mask[2 * word];
+    if (2 * word + 1 < mask.size()) {
+      result |= static_cast<uint64_t>(mask[2 * word + 1]) << 32;
+    }
+    if (edge_number - 64 * word < 64) {
+      result &= (uint64_t{1} << (edge_number - 64 * word)) - 1;
+    }
+    return result;
+  };
+
+  // Updates the edge order for the edges that change, given the old and the
+  // new connectivity words.
+  const auto update_edge_order = [this, offset](unsigned int word,
+                                                uint64_t old_bits,
+                                                uint64_t new_bits) {
+    for (uint64_t changed = old_bits ^ new_bits; changed != 0;
+         changed &= changed - 1) {
+      const unsigned int bit = __builtin_ctzll(changed);
+      UpdateEdgeOrder(offset + 64 * word + bit, (new_bits >> bit) & 1);
+    }
+  };
+
+  // If the whole layer comes from one parent, share it instead of copying.
+  bool all_father = true;
+  bool all_mother = true;
+  for (unsigned int word = 0; word < word_number; ++word) {
+    const uint64_t bits = mask_word(word);
+    const uint64_t valid_bits =
+        (edge_number - 64 * word >= 64
+             ? ~uint64_t{0}
+             : (uint64_t{1} << (edge_number - 64 * word)) - 1);
+    all_father = all_father && bits == valid_bits;
+    all_mother = all_mother && bits == 0;
+  }
+  if (all_father || all_mother) {
+    const std::shared_ptr<Layer>& parent_layer =
+        (all_father ? father : mother).layers_[layer_index];
+    if (parent_layer->arena() == arena()) {
+      const Layer& old_layer = *layers_[layer_index];
+      for (unsigned int word = 0; word < word_number; ++word) {
+        update_edge_order(word, old_layer.connectivity[word],
+                          parent_layer->connectivity[word]);
+      }
+      layers_[layer_index] = parent_layer;
+      return;
+    }
+  }
+
+  Layer& layer = MutableLayer(layer_index);
+  const Layer& father_layer = *father.layers_[layer_index];
+  const Layer& mother_layer = *mother.layers_[layer_index];
+
+  // Blend the connectivity word by word.
+  for (unsigned int word = 0; word < word_number; ++word) {
+    const uint64_t bits = mask_word(word);
+    const uint64_t connectivity = (father_layer.connectivity[word] & bits) |
+                                  (mother_layer.connectivity[word] & ~bits);
+    update_edge_order(word, layer.connectivity[word], connectivity);
+    layer.connectivity[word] = connectivity;
+  }
+
+  // Missing edges have weight 0, so the weights can be copied unconditionally.
+  double* const weights = layer.weight_matrix.values.data();
+  const double* const father_weights =
+      father_layer.weight_matrix.values.data();
+  const double* const mother_weights =
+      mother_layer.weight_matrix.values.data();
+  for (unsigned int i = 0; i < edge_number; ++i) {
+    const bool from_father = (mask[i / 32] >> (i % 32)) & 1u;
+    weights[i] = (from_father ? father_weights[i] : mother_weights[i]);
+  }
+}
+
+unsigned int SimpleNetwork::LayerConnectivityWords(unsigned int layer) const {
+  AssertLayerHasEdges(layer);
+  return layers_[layer]->connectivity.size();
+}
+
+const uint64_t* SimpleNetwork::LayerConnectivity(unsigned int layer) const {
+  AssertLayerHasEdges(layer);
+  return layers_[layer]->connectivity.data();
+}
+
+const double* SimpleNetwork::LayerWeights(unsigned int layer) const {
+  AssertLayerHasEdges(layer);
+  return layers_[layer]->weight_matrix.values.data();
+}
+
+void SimpleNetwork::SetLayer(unsigned int layer_index,
+                             const uint64_t* connectivity,
+                             const double* weights) {
+  AssertLayerHasEdges(layer_index);
+  compiled_plan_.reset();
+  Layer& layer = MutableLayer(layer_index);
+  const unsigned int offset = layer_edge_offsets_[layer_index];
+  const unsigned int edge_number = layer.EdgeNumber();
+  for (unsigned int word = 0; word < layer.connectivity.size(); ++word) {
+    uint64_t bits = connectivity[word];
+    if (edge_number - 64 * word < 64) {
+      bits &= (uint64_t{1} << (edge_number - 64 * word)) - 1;
+    }
+    for (uint64_t changed = bits ^ layer.connectivity[word]; changed != 0;
+         changed &= changed - 1) {
+      const unsigned int bit = __builtin_ctzll(changed);
+      UpdateEdgeOrder(offset + 64 * word + bit, (bits >> bit) & 1);
+    }
+    layer.connectivity[word] = bits;
+  }
+  for (unsigned int i = 0; i < edge_number; ++i) {
+    layer.weight_matrix.values[i] = (layer.HasEdge(i) ? weights[i] : 0.0);
+  }
+}
+
+unsigned int SimpleNetwork::ExistingEdgeCount() const {
+  return edge_order_->existing_count;
+}
+
+unsigned int SimpleNetwork::MissingEdgeCount() const {
+  return edge_order_->order.size() - edge_order_->existing_count;
+}
+
+unsigned int SimpleNetwork::CommonEdgeCount(const SimpleNetwork& other) const {
+  AssertSameShape(other);
+  unsigned int count = 0;
+  for (unsigned int layer = 0; layer < layers_.size(); ++layer) {
+    const auto& words = layers_[layer]->connectivity;
+    const auto& other_words = other.layers_[layer]->connectivity;
+    for (unsigned int word = 0; word < words.size(); ++word) {
+      count += __builtin_popcountll(words[word] & other_words[word]);
+    }
+  }
+  return count;
+}
+
+unsigned int SimpleNetwork::EdgeDistance(const SimpleNetwork& other) const {
+  AssertSameShape(other);
+  unsigned int count = 0;
+  for (unsigned int layer = 0; layer < layers_.size(); ++layer) {
+    const auto& words = layers_[layer]->connectivity;
+    const auto& other_words = other.layers_[layer]->connectivity;
+    for (unsigned int word = 0; word < words.size(); ++word) {
+      count += __builtin_popcountll(words[word] ^ other_words[word]);
+    }
+  }
+  return count;
+}
+
+SimpleNetwork::Edge SimpleNetwork::ExistingEdge(unsigned int index) const {
+  try {
+    AssertThat(index, IsLessThan(ExistingEdgeCount()));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  return IndexToEdge(edge_order_->order[index]);
+}
+
+SimpleNetwork::Edge SimpleNetwork::MissingEdge(unsigned int index) const {
+  try {
+    AssertThat(index, IsLessThan(MissingEdgeCount()));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  return IndexToEdge(edge_order_->order[edge_order_->existing_count + index]);
+}
+
+unsigned int SimpleNetwork::EdgeIndex(const Edge& edge) const {
+  const unsigned int layer_size = layers_[edge.from.layer]->weight_matrix.rows;
+  return layer_edge_offsets_[edge.from.layer] + edge.from.index +
+         edge.to.index * layer_size;
+}
+
+SimpleNetwork::Edge SimpleNetwork::IndexToEdge(unsigned int index) const {
+  unsigned int layer = 0;
+  while (index >= layer_edge_offsets_[layer + 1]) {
+    ++layer;
+  }
+  const unsigned int layer_index = index - layer_edge_offsets_[layer];
+  const unsigned int layer_size = layers_[layer]->weight_matrix.rows;
+  return Edge(layer, layer_index % layer_size, layer_index / layer_size);
+}
+
+void SimpleNetwork::UpdateEdgeOrder(unsigned int index, bool exists) {
+  const unsigned int position = edge_order_->positions[index];
+  if ((position < edge_order_->existing_count) == exists) {
+    return;
+  }
+
+  // Swap the edge with the first missing or the last existing edge and move
+  // the border over it.
+  EdgeOrder& edge_order = MutableEdgeOrder();
+  const unsigned int border =
+      (exists ? edge_order.existing_count : edge_order.existing_count - 1);
+  const unsigned int other_index = edge_order.order[border];
+  std::swap(edge_order.order[position], edge_order.order[border]);
+  edge_order.positions[index] = border;
+  edge_order.positions[other_index] = position;
+  if (exists) {
+    ++edge_order.existing_count;
+  } else {
+    --edge_order.existing_count;
+  }
+}
+
+SimpleNetwork::Layer& SimpleNetwork::MutableLayer(unsigned int layer) {
+  if (layers_[layer].use_count() > 1) {
+    layers_[layer] = CopyBlock(*layers_[layer], arena());
+  }
+  layers_[layer]->hash.store(0, std::memory_order_relaxed);
+  return *layers_[layer];
+}
+
+SimpleNetwork::EdgeOrder& SimpleNetwork::MutableEdgeOrder() {
+  if (edge_order_.use_count() > 1) {
+    edge_order_ = CopyBlock(*edge_order_, arena());
+  }
+  return *edge_order_;
+}
+
+std::size_t SimpleNetwork::Hash() const {
+  std::size_t hash = layers_.size();
+  for (const std::shared_ptr<Layer>& layer : layers_) {
+    hash = HashCombine(hash, LayerHash(*layer));
+  }
+  return hash;
+}
+
+std::size_t SimpleNetwork::LayerHash(const Layer& layer) {
+  std::size_t hash = layer.hash.load(std::memory_order_relaxed);
+  if (hash != 0) {
+    return hash;
+  }
+
+  hash = HashCombine(layer.weight_matrix.rows, layer.weight_matrix.cols);
+  for (const uint64_t word : layer.connectivity) {
+    hash = HashCombine(hash, word);
+  }
+  for (const double weight : layer.weight_matrix.values) {
+    uint64_t weight_bits;
+    std::memcpy(&weight_bits, &weight, sizeof(weight_bits));
+    hash = HashCombine(hash, weight_bits);
+  }
+
+  // 0 marks a missing hash.
+  hash = (hash == 0 ? 1 : hash);
+  layer.hash.store(hash, std::memory_order_relaxed);
+  return hash;
+}
+
+void SimpleNetwork::AssertLayerHasEdges(unsigned int layer) const {
+  try {
+    AssertThat(layer, IsLessThan(layers_.size()));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+}
+
+void SimpleNetwork::AssertSameShape(const SimpleNetwork& other) const {
+  try {
+    AssertThat(other.LayerNumber(), Equals(LayerNumber()));
+    for (unsigned int i = 0; i < LayerNumber(); ++i) {
+      AssertThat(other.LayerSize(i), Equals(LayerSize(i)));
+    }
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+}
+
 void SimpleNetwork::AssertEdgeIsValid(const Edge& edge) const {
   AssertNodeIsValid(edge.from);
   AssertNodeIsValid(edge.to);
@@ -90,36 +506,227 @@ void SimpleNetwork::AssertNodeIsValid(const Node& node) const {
 
 std::vector<double> SimpleNetwork::Forward(
     const std::vector<double>& input) const {
-  arma::rowvec layer_values(input);
+  try {
+    AssertThat(input.size(), Equals(LayerSize(0)));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  Workspace workspace(*this);
+  std::vector<double> result(LayerSize(LayerNumber() - 1));
+  Forward(input.data(), result.data(), &workspace);
+  return result;
+}
 
-  // Propagate the values forward through the layers.
-  for (const Layer& layer : layers_) {
-    layer_values = ForwardOneLayer(layer_values, layer);
+void SimpleNetwork::Forward(const double* input, double* output,
+                            Workspace* workspace) const {
+  if (compiled_plan_) {
+    ForwardCompiled(0, input, output, workspace);
+  } else {
+    ForwardFromLayer(0, input, output, workspace);
   }
+}
 
-  // Convert the result back to a vector and return.
-  std::vector<double> result;
-  for (unsigned int i = 0; i < layer_values.n_elem; ++i) {
-    result.push_back(layer_values(i));
+void SimpleNetwork::Forward(const std::vector<SparseInput>& input,
+                            double* output, Workspace* workspace) const {
+  if (compiled_plan_) {
+    ForwardCompiledSparse(input, output, workspace);
+    return;
   }
-  return result;
+
+  // Sum up the weights of the active inputs in the first buffer. The
+  // activation function can be applied in place afterwards.
+  double* const pre_activations = workspace->front_.data();
+  std::fill(pre_activations, pre_activations + LayerSize(1), 0.0);
+  for (const SparseInput& component : input) {
+    AddInputContribution(component.index, component.value, pre_activations);
+  }
+  ForwardFromPreActivations(pre_activations, output, workspace);
+}
+
+void SimpleNetwork::Compile() const {
+  if (compiled_plan_) {
+    return;
+  }
+
+  // Edges with weight 0 do not contribute anything and count as missing.
+  const auto live_edge = [this](unsigned int layer, unsigned int from,
+                                unsigned int to) {
+    return layers_[layer]->HasEdge(from + to * LayerSize(layer)) &&
+           layers_[layer]->weight_matrix(from, to) != 0.0;
+  };
+  const unsigned int layer_number = LayerNumber();
+
+  // Find the nodes with a path from the input.
+  std::vector<std::vector<bool>> from_input(layer_number);
+  from_input[0].assign(LayerSize(0), true);
+  for (unsigned int layer = 0; layer + 1 < layer_number; ++layer) {
+    from_input[layer + 1].assign(LayerSize(layer + 1), false);
+    for (unsigned int to = 0; to < LayerSize(layer + 1); ++to) {
+      for (unsigned int from = 0; from < LayerSize(layer); ++from) {
+        if (from_input[layer][from] && live_edge(layer, from, to)) {
+          from_input[layer + 1][to] = true;
+          break;
+        }
+      }
+    }
+  }
+
+  // Find the nodes with a path to the output.
+  std::vector<std::vector<bool>> to_output(layer_number);
+  to_output[layer_number - 1].assign(LayerSize(layer_number - 1), true);
+  for (unsigned int layer = layer_number - 1; layer > 0; --layer) {
+    to_output[layer - 1].assign(LayerSize(layer - 1), false);
+    for (unsigned int from = 0; from < LayerSize(layer - 1); ++from) {
+      for (unsigned int to = 0; to < LayerSize(layer); ++to) {
+        if (to_output[layer][to] && live_edge(layer - 1, from, to)) {
+          to_output[layer - 1][from] = true;
+          break;
+        }
+      }
+    }
+  }
+
+  // Nodes without a path from the input only depend on other such nodes, so
+  // their values are constant.
+  std::vector<std::vector<double>> constants(layer_number);
+  constants[0].assign(LayerSize(0), 0.0);
+  for (unsigned int layer = 1; layer < layer_number; ++layer) {
+    constants[layer].assign(LayerSize(layer), 0.0);
+    for (unsigned int to = 0; to < LayerSize(layer); ++to) {
+      if (from_input[layer][to]) {
+        continue;
+      }
+      double sum = 0.0;
+      for (unsigned int from = 0; from < LayerSize(layer - 1); ++from) {
+        if (live_edge(layer - 1, from, to)) {
+          sum += constants[layer - 1][from] *
+                 layers_[layer - 1]->weight_matrix(from, to);
+        }
+      }
+      constants[layer][to] = activation_function(sum);
+    }
+  }
+
+  // Number the live nodes on each layer. The output layer keeps all nodes.
+  std::vector<std::vector<int>> positions(layer_number);
+  for (unsigned int layer = 0; layer < layer_number; ++layer) {
+    positions[layer].assign(LayerSize(layer), -1);
+    int next_position = 0;
+    for (unsigned int node = 0; node < LayerSize(layer); ++node) {
+      if (layer + 1 == layer_number || to_output[layer][node]) {
+        positions[layer][node] = next_position++;
+      }
+    }
+  }
+
+  // Emit one step per layer, choosing the cheaper of the two representations.
+  // The edges of each target stay in the order of their source nodes, so the
+  // sums are rounded exactly like those of ForwardOneLayer. Only edges that
+  // add 0 are left out.
+  std::shared_ptr<CompiledPlan> plan = std::make_shared<CompiledPlan>();
+  for (unsigned int layer = 0; layer + 1 < layer_number; ++layer) {
+    CompiledLayer step;
+    std::vector<unsigned int> source_nodes;
+    for (unsigned int from = 0; from < LayerSize(layer); ++from) {
+      if (positions[layer][from] >= 0) {
+        source_nodes.push_back(from);
+        step.sources.push_back(layer == 0 ? from : positions[layer][from]);
+      }
+    }
+
+    std::vector<unsigned int> target_nodes;
+    unsigned int edge_count = 0;
+    for (unsigned int to = 0; to < LayerSize(layer + 1); ++to) {
+      if (positions[layer + 1][to] < 0) {
+        continue;
+      }
+      target_nodes.push_back(to);
+      const bool constant = !from_input[layer + 1][to];
+      step.constant.push_back(constant);
+      step.constant_values.push_back(constant ? constants[layer + 1][to]
+                                               : 0.0);
+      for (const unsigned int from : source_nodes) {
+        edge_count += (!constant && live_edge(layer, from, to));
+      }
+    }
+
+    const unsigned int block_size = source_nodes.size() * target_nodes.size();
+    step.dense = (block_size > 0 && 2 * edge_count >= block_size);
+    if (step.dense) {
+      step.weights.assign(block_size, 0.0);
+    } else {
+      step.edge_offsets.push_back(0);
+    }
+    if (layer == 0) {
+      step.input_rows.assign(LayerSize(0) * target_nodes.size(), 0.0);
+    }
+    for (unsigned int t = 0; t < target_nodes.size(); ++t) {
+      for (unsigned int s = 0; s < source_nodes.size(); ++s) {
+        const unsigned int from = source_nodes[s], to = target_nodes[t];
+        if (step.constant[t] || !live_edge(layer, from, to)) {
+          continue;
+        }
+        const double weight = layers_[layer]->weight_matrix(from, to);
+        if (step.dense) {
+          step.weights[s + t * source_nodes.size()] = weight;
+        } else {
+          step.edge_sources.push_back(step.sources[s]);
+          step.edge_weights.push_back(weight);
+        }
+        if (layer == 0) {
+          step.input_rows[from * target_nodes.size() + t] = weight;
+        }
+      }
+      if (!step.dense) {
+        step.edge_offsets.push_back(step.edge_sources.size());
+      }
+    }
+    plan->layers.push_back(std::move(step));
+  }
+  compiled_plan_ = std::move(plan);
+}
+
+bool SimpleNetwork::IsCompiled() const { return !!compiled_plan_; }
+
+SimpleNetwork::EdgeRange SimpleNetwork::Edges(EdgeFilter filter) const {
+  return EdgeRange(this, filter, 0, layers_.size());
+}
+
+SimpleNetwork::EdgeRange SimpleNetwork::Edges(unsigned int layer,
+                                              EdgeFilter filter) const {
+  try {
+    AssertThat(layer, IsLessThan(layers_.size()));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  return EdgeRange(this, filter, layer, layer + 1);
+}
+
+SimpleNetwork::EdgeRange SimpleNetwork::ExistingEdges() const {
+  return Edges(EXISTING_EDGES);
+}
+
+SimpleNetwork::EdgeRange SimpleNetwork::MissingEdges() const {
+  return Edges(MISSING_EDGES);
 }
 
 std::vector<SimpleNetwork::Edge> SimpleNetwork::AllEdges() const {
-  return AllEdges([](const Edge&) { return true; });
+  const EdgeRange edges = Edges();
+  return std::vector<Edge>(edges.begin(), edges.end());
 }
 
 std::vector<SimpleNetwork::Edge> SimpleNetwork::AllEdges(
     const std::function<bool(const Edge&)>& predicate) const {
   std::vector<Edge> result;
-  for (unsigned int i = 0; i < layers_.size(); ++i) {
-    for (const Node& node1 : NodesOnLayer(i)) {
-      for (const Node& node2 : NodesOnLayer(i + 1)) {
-        const Edge edge(node1, node2);
-        if (predicate(edge)) {
-          result.push_back(edge);
-        }
-      }
+  for (const Edge& edge : Edges()) {
+    if (predicate(edge)) {
+      result.push_back(edge);
     }
   }
   return result;
@@ -142,9 +749,380 @@ std::vector<SimpleNetwork::Node> SimpleNetwork::NodesOnLayer(
   return result;
 }
 
-arma::rowvec SimpleNetwork::ForwardOneLayer(const arma::rowvec& input,
-                                            const Layer& layer) const {
-  arma::rowvec next_values = input * layer.weight_matrix;
-  next_values.transform(activation_function);
-  return next_values;
+void SimpleNetwork::ForwardFromLayer(unsigned int first_layer,
+                                     const double* input, double* output,
+                                     Workspace* workspace) const {
+  // The inner layers alternate between the two workspace buffers, the last
+  // layer writes directly to the output.
+  double* const buffers[2] = {workspace->front_.data(),
+                              workspace->back_.data()};
+  const double* layer_values = input;
+  for (unsigned int i = first_layer; i < layers_.size(); ++i) {
+    double* const next_values =
+        (i + 1 == layers_.size() ? output : buffers[i % 2]);
+    ForwardOneLayer(layer_values, *layers_[i], next_values);
+    layer_values = next_values;
+  }
+}
+
+void SimpleNetwork::ForwardCompiled(unsigned int first_step,
+                                    const double* input, double* output,
+                                    Workspace* workspace) const {
+  // Same buffer scheme as ForwardFromLayer, but only live nodes are stored.
+  double* const buffers[2] = {workspace->front_.data(),
+                              workspace->back_.data()};
+  const std::vector<CompiledLayer>& steps = compiled_plan_->layers;
+  const double* previous_values = input;
+  for (unsigned int i = first_step; i < steps.size(); ++i) {
+    double* const next_values =
+        (i + 1 == steps.size() ? output : buffers[i % 2]);
+    ForwardCompiledLayer(steps[i], previous_values, next_values);
+    previous_values = next_values;
+  }
+}
+
+void SimpleNetwork::ForwardBatch(const double* inputs, unsigned int batch_size,
+                                 double* outputs, Workspace* workspace) const {
+  // Same buffer scheme as ForwardFromLayer, with one row per input. Each row
+  // is computed exactly like a single Forward call would.
+  double* const buffers[2] = {workspace->front_.data(),
+                              workspace->back_.data()};
+  const unsigned int step_number =
+      (compiled_plan_ ? compiled_plan_->layers.size() : layers_.size());
+  const double* values = inputs;
+  unsigned int size = LayerSize(0);
+  for (unsigned int i = 0; i < step_number; ++i) {
+    double* const next_values =
+        (i + 1 == step_number ? outputs : buffers[i % 2]);
+    if (compiled_plan_) {
+      const CompiledLayer& step = compiled_plan_->layers[i];
+      const unsigned int next_size = step.constant.size();
+      for (unsigned int b = 0; b < batch_size; ++b) {
+        ForwardCompiledLayer(step, values + b * size,
+                             next_values + b * next_size);
+      }
+      size = next_size;
+    } else {
+      const unsigned int next_size = LayerSize(i + 1);
+      for (unsigned int b = 0; b < batch_size; ++b) {
+        ForwardOneLayer(values + b * size, *layers_[i],
+                        next_values + b * next_size);
+      }
+      size = next_size;
+    }
+    values = next_values;
+  }
+}
+
+void SimpleNetwork::AddInputContribution(unsigned int index, double value,
+                                         double* pre_activations) const {
+  const Matrix<double>& weights = layers_.front()->weight_matrix;
+  for (unsigned int to = 0; to < weights.cols; ++to) {
+    pre_activations[to] += value * weights(index, to);
+  }
+}
+
+void SimpleNetwork::ForwardFromPreActivations(const double* pre_activations,
+                                              double* output,
+                                              Workspace* workspace) const {
+  // If there are no inner layers, the pre-activations belong to the output.
+  // Otherwise the first buffer is free because ForwardFromLayer(1, ...) starts
+  // writing to the second one.
+  const unsigned int size = LayerSize(1);
+  double* const values =
+      (layers_.size() == 1 ? output : workspace->front_.data());
+  for (unsigned int i = 0; i < size; ++i) {
+    values[i] = activation_function(pre_activations[i]);
+  }
+  if (layers_.size() > 1) {
+    ForwardFromLayer(1, values, output, workspace);
+  }
+}
+
+void SimpleNetwork::ForwardOneLayer(const double* input, const Layer& layer,
+                                    double* output) const {
+  // The matrix is stored column-major, so the weights of all incoming edges of
+  // a node are contiguous.
+  const Matrix<double>& weights = layer.weight_matrix;
+  for (unsigned int to = 0; to < weights.cols; ++to) {
+    const double* const column = weights.Column(to);
+    double sum = 0.0;
+    for (unsigned int from = 0; from < weights.rows; ++from) {
+      sum += input[from] * column[from];
+    }
+    output[to] = activation_function(sum);
+  }
+}
+
+void SimpleNetwork::ForwardCompiledSparse(
+    const std::vector<SparseInput>& input, double* output,
+    Workspace* workspace) const {
+  // Like the uncompiled sparse Forward, but on the first step of the plan.
+  const std::vector<CompiledLayer>& steps = compiled_plan_->layers;
+  const CompiledLayer& first = steps.front();
+  const unsigned int size = first.constant.size();
+  double* const values =
+      (steps.size() == 1 ? output : workspace->front_.data());
+  std::fill(values, values + size, 0.0);
+  for (const SparseInput& component : input) {
+    const double* const row = first.input_rows.data() + component.index * size;
+    for (unsigned int t = 0; t < size; ++t) {
+      values[t] += component.value * row[t];
+    }
+  }
+  for (unsigned int t = 0; t < size; ++t) {
+    values[t] = (first.constant[t] ? first.constant_values[t]
+                                   : activation_function(values[t]));
+  }
+  if (steps.size() > 1) {
+    ForwardCompiled(1, values, output, workspace);
+  }
+}
+
+void SimpleNetwork::ForwardCompiledLayer(const CompiledLayer& step,
+                                         const double* input,
+                                         double* output) const {
+  const unsigned int source_number = step.sources.size();
+  for (unsigned int t = 0; t < step.constant.size(); ++t) {
+    if (step.constant[t]) {
+      output[t] = step.constant_values[t];
+      continue;
+    }
+    double sum = 0.0;
+    if (step.dense) {
+      const double* const column = step.weights.data() + t * source_number;
+      for (unsigned int s = 0; s < source_number; ++s) {
+        sum += input[step.sources[s]] * column[s];
+      }
+    } else {
+      for (unsigned int e = step.edge_offsets[t]; e < step.edge_offsets[t + 1];
+           ++e) {
+        sum += input[step.edge_sources[e]] * step.edge_weights[e];
+      }
+    }
+    output[t] = activation_function(sum);
+  }
+}
+
+SimpleNetwork::EdgeRange::EdgeRange(const SimpleNetwork* network,
+                                    EdgeFilter filter,
+                                    unsigned int first_layer,
+                                    unsigned int end_layer)
+    : network_(network),
+      filter_(filter),
+      first_layer_(first_layer),
+      end_layer_(end_layer) {}
+
+SimpleNetwork::EdgeRange::Iterator SimpleNetwork::EdgeRange::begin() const {
+  Iterator iter(network_, filter_, first_layer_, end_layer_);
+  iter.SkipFilteredEdges();
+  return iter;
+}
+
+SimpleNetwork::EdgeRange::Iterator SimpleNetwork::EdgeRange::end() const {
+  return Iterator(network_, filter_, end_layer_, end_layer_);
+}
+
+bool SimpleNetwork::EdgeRange::empty() const { return begin() == end(); }
+
+unsigned int SimpleNetwork::EdgeRange::size() const {
+  unsigned int size = 0;
+  for (unsigned int layer = first_layer_; layer < end_layer_; ++layer) {
+    const Layer& layer_edges = *network_->layers_[layer];
+    switch (filter_) {
+      case ALL_EDGES:
+        size += layer_edges.EdgeNumber();
+        break;
+      case EXISTING_EDGES:
+        size += layer_edges.ExistingEdgeNumber();
+        break;
+      case MISSING_EDGES:
+        size += layer_edges.EdgeNumber() - layer_edges.ExistingEdgeNumber();
+        break;
+    }
+  }
+  return size;
+}
+
+SimpleNetwork::EdgeRange::Iterator::Iterator(const SimpleNetwork* network,
+                                             EdgeFilter filter,
+                                             unsigned int layer,
+                                             unsigned int end_layer)
+    : network_(network),
+      filter_(filter),
+      layer_(layer),
+      end_layer_(end_layer) {}
+
+SimpleNetwork::Edge SimpleNetwork::EdgeRange::Iterator::operator*() const {
+  return Edge(layer_, from_, to_);
+}
+
+SimpleNetwork::EdgeRange::Iterator& SimpleNetwork::EdgeRange::Iterator::
+operator++() {
+  Step();
+  SkipFilteredEdges();
+  return *this;
+}
+
+SimpleNetwork::EdgeRange::Iterator SimpleNetwork::EdgeRange::Iterator::
+operator++(int) {
+  const Iterator result = *this;
+  ++*this;
+  return result;
+}
+
+bool SimpleNetwork::EdgeRange::Iterator::operator==(
+    const Iterator& other) const {
+  return layer_ == other.layer_ && from_ == other.from_ && to_ == other.to_;
+}
+
+bool SimpleNetwork::EdgeRange::Iterator::operator!=(
+    const Iterator& other) const {
+  return !(*this == other);
+}
+
+void SimpleNetwork::EdgeRange::Iterator::SkipFilteredEdges() {
+  if (filter_ == ALL_EDGES) {
+    return;
+  }
+  // Jump to the next set (or unset) bit of the connectivity.
+  const bool want_existing = (filter_ == EXISTING_EDGES);
+  while (layer_ < end_layer_) {
+    const Layer& layer = *network_->layers_[layer_];
+    const unsigned int rows = layer.weight_matrix.rows;
+    const unsigned int next_edge =
+        layer.NextEdge(from_ + to_ * rows, want_existing);
+    if (next_edge < layer.EdgeNumber()) {
+      from_ = next_edge % rows;
+      to_ = next_edge / rows;
+      return;
+    }
+    from_ = 0;
+    to_ = 0;
+    ++layer_;
+  }
+}
+
+void SimpleNetwork::EdgeRange::Iterator::Step() {
+  // Walk through the matrices in their column-major storage order.
+  const Matrix<double>& matrix = network_->layers_[layer_]->weight_matrix;
+  if (++from_ < matrix.rows) {
+    return;
+  }
+  from_ = 0;
+  if (++to_ < matrix.cols) {
+    return;
+  }
+  to_ = 0;
+  ++layer_;
+}
+
+unsigned int SimpleNetwork::Layer::NextEdge(unsigned int i, bool exists) const {
+  const unsigned int edge_number = EdgeNumber();
+  if (i >= edge_number) {
+    return edge_number;
+  }
+
+  // Look for a set bit, inverting the words when looking for missing edges.
+  const uint64_t invert = (exists ? 0 : ~uint64_t{0});
+  unsigned int word = i / 64;
+  uint64_t bits = (connectivity[word] ^ invert) & (~uint64_t{0} << (i % 64));
+  while (bits == 0) {
+    if (++word == connectivity.size()) {
+      return edge_number;
+    }
+    bits = connectivity[word] ^ invert;
+  }
+  return std::min(edge_number, 64 * word + __builtin_ctzll(bits));
+}
+
+unsigned int SimpleNetwork::Layer::ExistingEdgeNumber() const {
+  unsigned int count = 0;
+  for (const uint64_t word : connectivity) {
+    count += __builtin_popcountll(word);
+  }
+  return count;
+}
+
+SimpleNetwork::Workspace::Workspace(const SimpleNetwork& network,
+                                    unsigned int batch_size) {
+  Reserve(network, batch_size);
+}
+
+void SimpleNetwork::Workspace::Reserve(const SimpleNetwork& network,
+                                       unsigned int batch_size) {
+  unsigned int max_layer_size = 0;
+  for (unsigned int i = 0; i < network.LayerNumber(); ++i) {
+    max_layer_size = std::max(max_layer_size, network.LayerSize(i));
+  }
+  const std::size_t size = std::size_t{max_layer_size} * batch_size;
+  if (front_.size() < size) {
+    front_.resize(size);
+    back_.resize(size);
+  }
+}
+
+SimpleNetwork::Accumulator::Accumulator(const SimpleNetwork* network,
+                                        const double* input)
+    : network_(network),
+      input_(input, input + network->LayerSize(0)),
+      pre_activations_(network->LayerSize(1), 0.0) {
+  // Compute the initial pre-activations column by column.
+  const Matrix<double>& weights = network_->layers_.front()->weight_matrix;
+  for (unsigned int to = 0; to < weights.cols; ++to) {
+    const double* const column = weights.Column(to);
+    double sum = 0.0;
+    for (unsigned int from = 0; from < weights.rows; ++from) {
+      sum += input_[from] * column[from];
+    }
+    pre_activations_[to] = sum;
+  }
+}
+
+void SimpleNetwork::Accumulator::Push(unsigned int index, double value) {
+  const unsigned int depth = changes_.size();
+  const unsigned int size = network_->LayerSize(1);
+  if (pre_activations_.size() < (depth + 2) * size) {
+    pre_activations_.resize((depth + 2) * size);
+  }
+
+  // Copy the current pre-activations and update them with the difference.
+  std::copy(PreActivations(depth), PreActivations(depth) + size,
+            PreActivations(depth + 1));
+  network_->AddInputContribution(index, value - input_[index],
+                                 PreActivations(depth + 1));
+  changes_.push_back(Change{index, input_[index]});
+  input_[index] = value;
+}
+
+void SimpleNetwork::Accumulator::Pop() {
+  try {
+    AssertThat(changes_.size(), IsGreaterThan(0u));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  input_[changes_.back().index] = changes_.back().previous_value;
+  changes_.pop_back();
+}
+
+double SimpleNetwork::Accumulator::Input(unsigned int index) const {
+  return input_[index];
+}
+
+void SimpleNetwork::Accumulator::Forward(double* output,
+                                         Workspace* workspace) const {
+  network_->ForwardFromPreActivations(PreActivations(changes_.size()), output,
+                                      workspace);
+}
+
+double* SimpleNetwork::Accumulator::PreActivations(unsigned int depth) {
+  return pre_activations_.data() + depth * network_->LayerSize(1);
+}
+
+const double* SimpleNetwork::Accumulator::PreActivations(
+    unsigned int depth) const {
+  return pre_activations_.data() + depth * network_->LayerSize(1);
 }
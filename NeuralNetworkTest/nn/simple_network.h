@@ -1,8 +1,14 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <iterator>
+#include <memory>
 #include <vector>
-#include "armadillo"
+
+#include "util/memory/arena.h"
 
 // Network of fixed size with nodes that pass values to the next layer.
 class SimpleNetwork {
@@ -27,9 +33,160 @@ class SimpleNetwork {
         : from(layer_from, node_from), to(layer_from + 1, node_to) {}
   };
 
+  // Selects which edges an EdgeRange visits.
+  enum EdgeFilter { ALL_EDGES = 0, EXISTING_EDGES = 1, MISSING_EDGES = 2 };
+
+  // A lazy view of the possible edges starting on a range of layers,
+  // optionally restricted to the existing or missing ones. The edges are read
+  // directly from the network while iterating, so nothing is allocated. The
+  // order is the storage order of the network. Adding or removing edges while
+  // iterating affects which of the remaining edges are visited.
+  class EdgeRange {
+   public:
+    class Iterator {
+     public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = Edge;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const Edge*;
+      using reference = Edge;
+
+      Edge operator*() const;
+      Iterator& operator++();
+      Iterator operator++(int);
+      bool operator==(const Iterator& other) const;
+      bool operator!=(const Iterator& other) const;
+
+     private:
+      friend class EdgeRange;
+
+      Iterator(const SimpleNetwork* network, EdgeFilter filter,
+               unsigned int layer, unsigned int end_layer);
+
+      // Moves forward until an edge matching the filter is found.
+      void SkipFilteredEdges();
+
+      // Moves to the next possible edge.
+      void Step();
+
+      const SimpleNetwork* network_;
+      EdgeFilter filter_;
+      unsigned int layer_;
+      unsigned int end_layer_;
+      unsigned int from_ = 0;
+      unsigned int to_ = 0;
+    };
+
+    Iterator begin() const;
+    Iterator end() const;
+
+    // Returns whether the range contains no edges.
+    bool empty() const;
+
+    // Returns the number of edges in the range. This counts the bits of the
+    // connectivity of each layer in the range.
+    unsigned int size() const;
+
+   private:
+    friend class SimpleNetwork;
+
+    EdgeRange(const SimpleNetwork* network, EdgeFilter filter,
+              unsigned int first_layer, unsigned int end_layer);
+
+    const SimpleNetwork* network_;
+    EdgeFilter filter_;
+    unsigned int first_layer_;
+    unsigned int end_layer_;
+  };
+
+  // A non-zero component of a sparse network input.
+  struct SparseInput {
+    unsigned int index;
+    double value;
+  };
+
+  // Scratch memory for the allocation-free Forward overload. A workspace is
+  // sized once for the shape of a network and can then be reused for any number
+  // of Forward calls on networks of that shape.
+  class Workspace {
+   public:
+    Workspace() = default;
+    explicit Workspace(const SimpleNetwork& network,
+                       unsigned int batch_size = 1);
+
+    // Grows the buffers so that they fit the given network, for ForwardBatch
+    // with up to batch_size inputs. Nothing is allocated if they are large
+    // enough already.
+    void Reserve(const SimpleNetwork& network, unsigned int batch_size = 1);
+
+   private:
+    friend class SimpleNetwork;
+
+    // The values of the inner layers alternate between these two buffers.
+    std::vector<double> front_;
+    std::vector<double> back_;
+  };
+
+  // Evaluates the network for inputs that change one component at a time, in
+  // the style of NNUE accumulators. The pre-activations of the first inner
+  // layer are cached and updated in O(LayerSize(1)) per changed input. Changes
+  // are kept on a stack so that they can be undone, e.g. while walking a game
+  // tree. The network must outlive the accumulator and must not be changed
+  // while the accumulator is in use.
+  class Accumulator {
+   public:
+    Accumulator(const SimpleNetwork* network, const double* input);
+
+    // Sets an input component to a new value and remembers the change.
+    void Push(unsigned int index, double value);
+
+    // Undoes the most recent change that has not been undone yet.
+    void Pop();
+
+    // Returns the current value of an input component.
+    double Input(unsigned int index) const;
+
+    // Runs the network on the current input.
+    void Forward(double* output, Workspace* workspace) const;
+
+   private:
+    struct Change {
+      unsigned int index;
+      double previous_value;
+    };
+
+    // The pre-activations after the given number of changes.
+    double* PreActivations(unsigned int depth);
+    const double* PreActivations(unsigned int depth) const;
+
+    const SimpleNetwork* network_;
+    std::vector<double> input_;
+    std::vector<Change> changes_;
+
+    // One block of LayerSize(1) values per change depth. Blocks of undone
+    // changes are kept so that pushing again does not allocate.
+    std::vector<double> pre_activations_;
+  };
+
   // Constructs a new network with the given number of layers and nodes on each
-  // layer. The first layer is the input, the last layer is the output.
-  SimpleNetwork(const std::vector<int>& layer_sizes);
+  // layer. The first layer is the input, the last layer is the output. If an
+  // arena is given, the network stores its edges in it and must not be used
+  // after the arena is reset.
+  SimpleNetwork(const std::vector<int>& layer_sizes,
+                ::util::memory::Arena* arena = nullptr);
+
+  // Copies a network into an arena. Plain copies are always stored on the
+  // heap. Copies share the storage of layers that are stored in the same place
+  // until either network changes them (copy-on-write), so copying is cheap.
+  SimpleNetwork(const SimpleNetwork& other, ::util::memory::Arena* arena);
+
+  SimpleNetwork(const SimpleNetwork& other);
+  SimpleNetwork(SimpleNetwork&& other) = default;
+  SimpleNetwork& operator=(const SimpleNetwork& other);
+  SimpleNetwork& operator=(SimpleNetwork&& other) = default;
+
+  // The arena the network is stored in, or nullptr for the heap.
+  ::util::memory::Arena* arena() const;
 
   // Returns the number of layers (including input and output).
   unsigned int LayerNumber() const;
@@ -55,9 +212,112 @@ class SimpleNetwork {
   // Removes a connection from the network.
   void RemoveConnection(const Edge& edge);
 
+  // Replaces the edges starting on one layer by a mix of the edges of two
+  // parents with the same shape as this network. Bit i of the mask selects
+  // whether the edge with index i in the storage order of the layer, i.e.
+  // from + to * LayerSize(layer), is copied from the father (1) or the
+  // mother (0). The bits are packed into 32 bit words.
+  void InheritLayer(unsigned int layer, const SimpleNetwork& father,
+                    const SimpleNetwork& mother,
+                    const std::vector<uint32_t>& mask);
+
+  // Direct access to the edges starting on a layer, for bulk reading and
+  // writing. The edges are in the storage order from + to * LayerSize(layer).
+  // Bit i % 64 of connectivity word i / 64 is set iff edge i exists; there are
+  // LayerConnectivityWords(layer) words. Missing edges have weight 0.
+  unsigned int LayerConnectivityWords(unsigned int layer) const;
+  const uint64_t* LayerConnectivity(unsigned int layer) const;
+  const double* LayerWeights(unsigned int layer) const;
+
+  // Replaces all edges starting on a layer, in the format of
+  // LayerConnectivity and LayerWeights. Bits beyond the last edge are ignored
+  // and the weights of missing edges are set to 0.
+  void SetLayer(unsigned int layer, const uint64_t* connectivity,
+                const double* weights);
+
   // Runs the network on some input and returns the output.
   std::vector<double> Forward(const std::vector<double>& input) const;
 
+  // Runs the network on some input without allocating memory. "input" has to
+  // hold LayerSize(0) values and "output" has to have room for the
+  // LayerSize(LayerNumber() - 1) output values. The workspace has to fit the
+  // shape of this network.
+  void Forward(const double* input, double* output,
+               Workspace* workspace) const;
+
+  // Runs the network on an input which is zero except for the listed
+  // components. On the first layer only the weights of those components are
+  // read. Otherwise this behaves like the overload above, including the use of
+  // a compiled plan. If the components are sorted by index, the output is
+  // exactly that of the dense input.
+  void Forward(const std::vector<SparseInput>& input, double* output,
+               Workspace* workspace) const;
+
+  // Runs the network on batch_size inputs at once. The inputs and outputs are
+  // stored one after another, i.e. input b starts at inputs + b * LayerSize(0).
+  // Each layer is applied to the whole batch before moving on to the next one,
+  // so its weights stay in cache. The results are exactly those of Forward.
+  // The workspace has to be reserved for the batch size.
+  void ForwardBatch(const double* inputs, unsigned int batch_size,
+                    double* outputs, Workspace* workspace) const;
+
+  // Computes which nodes can influence the output and caches a compact
+  // evaluation plan for them, so that Forward only touches the live part of
+  // the network afterwards. Nodes without a path from the input have constant
+  // values which are stored in the plan, so the activation function must not
+  // be changed after compiling. The plan sums in the same order as the
+  // uncompiled network and only skips terms that are 0, so for finite inputs
+  // the outputs are exactly the same. Adding or removing connections discards
+  // the plan.
+  //
+  // Although this is const, it changes the cached plan without
+  // synchronization: it must not run concurrently with any other call on the
+  // same network, including Forward. Networks that are evaluated by several
+  // threads at once have to be compiled before they are shared; calling
+  // Compile again on a compiled network does not change anything.
+  //
+  // Compiling visits every possible edge a few times, which costs about as
+  // much as a handful of Forward calls. It pays off for networks that are
+  // evaluated many times, e.g. by a fitness function, which should therefore
+  // compile the network before playing.
+  void Compile() const;
+
+  // Returns whether a compiled plan is currently cached.
+  bool IsCompiled() const;
+
+  // Returns a hash of the edges and weights of the network. The hash of each
+  // layer is cached, so this is cheap for networks that share most of their
+  // layers with an already hashed network. The activation function is not
+  // part of the hash.
+  std::size_t Hash() const;
+
+  // Returns a view of all edges that can possibly exist in this node setup,
+  // optionally filtered. The second version only contains the edges starting on
+  // the given layer.
+  EdgeRange Edges(EdgeFilter filter = ALL_EDGES) const;
+  EdgeRange Edges(unsigned int layer, EdgeFilter filter = ALL_EDGES) const;
+
+  // Shorthands for Edges(EXISTING_EDGES) and Edges(MISSING_EDGES).
+  EdgeRange ExistingEdges() const;
+  EdgeRange MissingEdges() const;
+
+  // Returns the number of existing/missing edges in constant time.
+  unsigned int ExistingEdgeCount() const;
+  unsigned int MissingEdgeCount() const;
+
+  // Compares the edges of two networks with the same layer sizes: the number of
+  // edges that exist in both networks and the number of edges that exist in
+  // exactly one of them. Weights are ignored.
+  unsigned int CommonEdgeCount(const SimpleNetwork& other) const;
+  unsigned int EdgeDistance(const SimpleNetwork& other) const;
+
+  // Returns the existing/missing edge with the given index, where the index is
+  // less than the respective count. The order is unspecified and changes when
+  // edges are added or removed, but the lookup takes constant time, so a
+  // uniformly random index selects a uniformly random edge.
+  Edge ExistingEdge(unsigned int index) const;
+  Edge MissingEdge(unsigned int index) const;
+
   // Returns a list of all edges that can possibly exist in this node setup. If
   // the parameter is set, it is used as a filter to only keep those edges in
   // the list which evaluate to true.
@@ -78,27 +338,175 @@ class SimpleNetwork {
   friend class SimpleNetworkTest;
 
  private:
+  // A matrix in column-major order, so that element (from, to) of a layer has
+  // the index from + to * rows.
+  template <typename T>
+  struct Matrix {
+    Matrix(unsigned int rows, unsigned int cols, ::util::memory::Arena* arena)
+        : rows(rows), cols(cols), values(rows * cols, T(), arena) {}
+    Matrix(const Matrix& other, ::util::memory::Arena* arena)
+        : rows(other.rows),
+          cols(other.cols),
+          values(other.values.begin(), other.values.end(), arena) {}
+
+    T& operator()(unsigned int row, unsigned int col) {
+      return values[row + col * rows];
+    }
+    const T& operator()(unsigned int row, unsigned int col) const {
+      return values[row + col * rows];
+    }
+    const T* Column(unsigned int col) const { return &values[col * rows]; }
+
+    unsigned int rows;
+    unsigned int cols;
+    ::util::memory::ArenaVector<T> values;
+  };
+
+  // The edges starting on one layer. Layers are shared between copies of a
+  // network and must only be changed through MutableLayer.
   struct Layer {
-    Layer(int size, int next_layer_size)
-        : connectivity_matrix(size, next_layer_size, arma::fill::zeros),
-          weight_matrix(size, next_layer_size, arma::fill::zeros) {}
+    Layer(int size, int next_layer_size, ::util::memory::Arena* arena)
+        : weight_matrix(size, next_layer_size, arena),
+          connectivity((size * next_layer_size + 63) / 64, 0, arena) {}
+    Layer(const Layer& other, ::util::memory::Arena* arena)
+        : weight_matrix(other.weight_matrix, arena),
+          connectivity(other.connectivity.begin(), other.connectivity.end(),
+                       arena),
+          hash(other.hash.load(std::memory_order_relaxed)) {}
+
+    ::util::memory::Arena* arena() const {
+      return weight_matrix.values.get_allocator().arena();
+    }
+
+    // The number of possible edges.
+    unsigned int EdgeNumber() const { return weight_matrix.values.size(); }
+
+    // Reads or writes the bit of edge i in storage order.
+    bool HasEdge(unsigned int i) const {
+      return (connectivity[i / 64] >> (i % 64)) & 1;
+    }
+    void SetEdge(unsigned int i, bool exists) {
+      const uint64_t bit = uint64_t{1} << (i % 64);
+      connectivity[i / 64] =
+          (exists ? connectivity[i / 64] | bit : connectivity[i / 64] & ~bit);
+    }
+
+    // Returns the first edge at or after i that exists (or is missing), or
+    // EdgeNumber() if there is none.
+    unsigned int NextEdge(unsigned int i, bool exists) const;
+
+    // The number of existing edges.
+    unsigned int ExistingEdgeNumber() const;
+
+    Matrix<double> weight_matrix;
+
+    // Bit i % 64 of word i / 64 is set iff edge i exists. The edges are in the
+    // storage order of weight_matrix. The unused bits of the last word are 0.
+    ::util::memory::ArenaVector<uint64_t> connectivity;
 
-    arma::Mat<unsigned int> connectivity_matrix;
-    arma::Mat<double> weight_matrix;
+    // The cached hash of the layer, or 0 if it has not been computed yet.
+    mutable std::atomic<std::size_t> hash{0};
   };
 
+  // The index of all possible edges. The order is partitioned so that the
+  // first existing_count entries are the existing edges and the rest are the
+  // missing ones. Adding or removing an edge swaps it across the border.
+  // positions holds the position of each edge in order. Like the layers, it is
+  // shared between copies and must only be changed through MutableEdgeOrder.
+  struct EdgeOrder {
+    explicit EdgeOrder(::util::memory::Arena* arena)
+        : order(arena), positions(arena) {}
+    EdgeOrder(const EdgeOrder& other, ::util::memory::Arena* arena)
+        : order(other.order.begin(), other.order.end(), arena),
+          positions(other.positions.begin(), other.positions.end(), arena),
+          existing_count(other.existing_count) {}
+
+    ::util::memory::Arena* arena() const {
+      return order.get_allocator().arena();
+    }
+
+    ::util::memory::ArenaVector<unsigned int> order;
+    ::util::memory::ArenaVector<unsigned int> positions;
+    unsigned int existing_count = 0;
+  };
+
+  // Returns a layer or the edge order for writing. They are copied first if
+  // they are shared with another network.
+  Layer& MutableLayer(unsigned int layer);
+  EdgeOrder& MutableEdgeOrder();
+
+  // Computes the hash of a layer or returns the cached one.
+  static std::size_t LayerHash(const Layer& layer);
+
+  // The evaluation plan produced by Compile, see simple_network.cc.
+  struct CompiledLayer;
+  struct CompiledPlan;
+
+  // Runs the network on the cached plan, starting at the given step. "input"
+  // holds the values of the live nodes of the layer of that step.
+  void ForwardCompiled(unsigned int first_step, const double* input,
+                       double* output, Workspace* workspace) const;
+
+  // Runs the network on a sparse input and the cached plan.
+  void ForwardCompiledSparse(const std::vector<SparseInput>& input,
+                             double* output, Workspace* workspace) const;
+
+  // Converts between edges and their index in the storage order of the whole
+  // network.
+  unsigned int EdgeIndex(const Edge& edge) const;
+  Edge IndexToEdge(unsigned int index) const;
+
+  // Moves an edge to the existing or the missing part of edge_order_.
+  void UpdateEdgeOrder(unsigned int index, bool exists);
+
   // Asserts that the edge/node is present in the network.
   void AssertEdgeIsValid(const Edge& edge) const;
+
+  // Asserts that edges start on the layer, i.e. that it is not the output.
+  void AssertLayerHasEdges(unsigned int layer) const;
+
+  // Asserts that the other network has the same layer sizes.
+  void AssertSameShape(const SimpleNetwork& other) const;
   void AssertNodeIsValid(const Node& node) const;
 
+  // Adds the contribution of one input component to the pre-activations of the
+  // first inner layer.
+  void AddInputContribution(unsigned int index, double value,
+                            double* pre_activations) const;
+
+  // Applies the activation function to the pre-activations of the first inner
+  // layer and runs the rest of the network.
+  void ForwardFromPreActivations(const double* pre_activations, double* output,
+                                 Workspace* workspace) const;
+
+  // Runs the network starting at the given layer. "input" holds the values of
+  // the nodes on that layer.
+  void ForwardFromLayer(unsigned int first_layer, const double* input,
+                        double* output, Workspace* workspace) const;
+
   // Propagates data of one layer to the next.
-  arma::rowvec ForwardOneLayer(const arma::rowvec& input,
-                               const Layer& layer) const;
+  void ForwardOneLayer(const double* input, const Layer& layer,
+                       double* output) const;
+
+  // Propagates data through one step of the compiled plan.
+  void ForwardCompiledLayer(const CompiledLayer& step, const double* input,
+                            double* output) const;
 
   // The list of layers, beginning with the input layer and followed by the
   // inner layers. The output layer is not present as it does not have outgoing
-  // edges.
-  std::vector<Layer> layers_;
+  // edges. A layer is only shared with networks that are stored in the same
+  // arena (or on the heap), so that it lives as long as each of them.
+  ::util::memory::ArenaVector<std::shared_ptr<Layer>> layers_;
+
+  // The index of the first edge of each layer in the storage order of the whole
+  // network, followed by the total number of possible edges.
+  ::util::memory::ArenaVector<unsigned int> layer_edge_offsets_;
+
+  // The index of all possible edges, see EdgeOrder.
+  std::shared_ptr<EdgeOrder> edge_order_;
+
+  // The plan created by Compile; it is shared between copies of the network.
+  mutable std::shared_ptr<const CompiledPlan> compiled_plan_;
 };
 
 template <typename StreamT>
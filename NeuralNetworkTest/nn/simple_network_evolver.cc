@@ -7,7 +7,31 @@
 using namespace snowhouse;
 
 SimpleNetworkEvolver::SimpleNetworkEvolver(const Options& options)
-    : options_(options) {}
+    : options_(options), weight_change_(0.0, options.mutation_weight_stddev) {
+  // Use a weighted distribution to select the change in edge numbers.
+  const auto distribution_map_pair =
+      ::util::random::WeightedDistribution::FromMap(
+          options_.mutation_grow_probabilities);
+  growth_distribution_ = distribution_map_pair.first;
+  growth_values_.resize(distribution_map_pair.second.size());
+  for (const auto& index_growth_pair : distribution_map_pair.second) {
+    growth_values_[index_growth_pair.first] = index_growth_pair.second;
+  }
+
+  // The gaps between edges with mutated weights are geometrically
+  // distributed. The distribution is only defined for chances in (0, 1).
+  const double weight_chance = options_.mutation_weight_chance;
+  if (weight_chance > 0.0 && weight_chance < 1.0) {
+    weight_mutation_gap_ =
+        std::geometric_distribution<unsigned int>(weight_chance);
+  }
+
+  if (options_.use_generation_arena) {
+    child_arena_.reset(new ::util::memory::Arena());
+    survivor_arena_.reset(new ::util::memory::Arena());
+    next_survivor_arena_.reset(new ::util::memory::Arena());
+  }
+}
 
 SimpleNetwork SimpleNetworkEvolver::InitialSpecimen() {
   SimpleNetwork specimen(options_.layer_sizes);
@@ -30,8 +54,18 @@ SimpleNetwork SimpleNetworkEvolver::InitialSpecimen() {
 
 SimpleNetwork SimpleNetworkEvolver::Mate(const SimpleNetwork& father,
                                          const SimpleNetwork& mother) {
-  // Both parents have to have the same layer sizes which is also copied to the
-  // offspring.
+  std::vector<int> layer_sizes;
+  for (unsigned int i = 0; i < father.LayerNumber(); ++i) {
+    layer_sizes.push_back(father.LayerSize(i));
+  }
+  SimpleNetwork offspring(layer_sizes, child_arena_.get());
+  MateInto(father, mother, &offspring);
+  return offspring;
+}
+
+void SimpleNetworkEvolver::MateInto(const SimpleNetwork& father,
+                                    const SimpleNetwork& mother,
+                                    SimpleNetwork* out) {
   try {
     AssertThat(father.LayerNumber(), Equals(mother.LayerNumber()));
     for (unsigned int i = 0; i < father.LayerNumber(); ++i) {
@@ -43,42 +77,110 @@ SimpleNetwork SimpleNetworkEvolver::Mate(const SimpleNetwork& father,
     exit(1);
   }
 
-  std::vector<int> layer_sizes;
-  for (unsigned int i = 0; i < father.LayerNumber(); ++i) {
-    layer_sizes.push_back(father.LayerSize(i));
+  // Only reallocate the offspring if its shape does not match. Every layer
+  // is overwritten below.
+  bool same_shape = (out->LayerNumber() == father.LayerNumber());
+  for (unsigned int i = 0; same_shape && i < father.LayerNumber(); ++i) {
+    same_shape = (out->LayerSize(i) == father.LayerSize(i));
   }
-  SimpleNetwork offspring(layer_sizes);
-
-  // For each edge, randomly copy the father or the mother.
-  for (const SimpleNetwork::Edge& edge : offspring.AllEdges()) {
-    const SimpleNetwork& hereditary_parent =
-        ::util::random::RollPercentage(0.5) ? father : mother;
-    if (hereditary_parent.HasConnection(edge)) {
-      offspring.AddConnection(edge, hereditary_parent.ConnectionWeight(edge));
+  if (!same_shape) {
+    std::vector<int> layer_sizes;
+    for (unsigned int i = 0; i < father.LayerNumber(); ++i) {
+      layer_sizes.push_back(father.LayerSize(i));
     }
+    *out = SimpleNetwork(layer_sizes, out->arena());
+  }
+
+  // Combine the parents layer by layer according to a random mask.
+  for (unsigned int layer = 0; layer + 1 < out->LayerNumber(); ++layer) {
+    CrossoverMask(out->LayerSize(layer), out->LayerSize(layer + 1),
+                  &crossover_mask_);
+    out->InheritLayer(layer, father, mother, crossover_mask_);
   }
-  return offspring;
 }
 
 SimpleNetwork SimpleNetworkEvolver::Mutate(const SimpleNetwork& specimen) {
   SimpleNetwork mutated_specimen = specimen;
+  MutateInPlace(&mutated_specimen);
+  return mutated_specimen;
+}
+
+void SimpleNetworkEvolver::MutateInPlace(SimpleNetwork* specimen) {
+  // The weight mutations are selected first, so only edges that existed
+  // before the growth are affected.
+  SelectWeightMutations(*specimen);
 
   // Add or remove edges.
   if (::util::random::RollPercentage(options_.mutation_grow_chance)) {
-    MutateGrowth(&mutated_specimen);
+    MutateGrowth(specimen);
   }
 
-  // Change weights on existing edges.
-  const auto edge_exists = std::bind(&SimpleNetwork::HasConnection, &specimen,
-                                     std::placeholders::_1);
-  for (const SimpleNetwork::Edge& edge :
-       mutated_specimen.AllEdges(edge_exists)) {
-    if (::util::random::RollPercentage(options_.mutation_weight_chance)) {
-      MutateWeight(&mutated_specimen, edge);
-    }
+  // Change weights on the selected edges.
+  for (const SimpleNetwork::Edge& edge : weight_mutations_) {
+    MutateWeight(specimen, edge);
   }
+}
 
-  return mutated_specimen;
+void SimpleNetworkEvolver::EndGeneration(
+    std::vector<SimpleNetwork>* survivors, std::vector<SimpleNetwork>* dead) {
+  if (!options_.use_generation_arena) {
+    return;
+  }
+
+  // Copy the survivors next to each other. The arena of the previous
+  // survivors is still alive in case a survivor is stored in it.
+  dead->clear();
+  next_survivor_arena_->Reset();
+  for (SimpleNetwork& survivor : *survivors) {
+    survivor = SimpleNetwork(survivor, next_survivor_arena_.get());
+  }
+  std::swap(survivor_arena_, next_survivor_arena_);
+  child_arena_->Reset();
+}
+
+void SimpleNetworkEvolver::CrossoverMask(unsigned int layer_size,
+                                         unsigned int next_layer_size,
+                                         std::vector<uint32_t>* mask) const {
+  const unsigned int edge_number = layer_size * next_layer_size;
+  mask->assign((edge_number + 31) / 32, 0);
+  const auto set_bit = [mask](unsigned int i) {
+    (*mask)[i / 32] |= (1u << (i % 32));
+  };
+
+  switch (options_.crossover_strategy) {
+    case Options::UNIFORM_CROSSOVER:
+      // The generator produces 32 uniformly random bits at once.
+      for (uint32_t& word : *mask) {
+        word = (*::util::random::StaticGenerator())();
+      }
+      break;
+    case Options::BIASED_UNIFORM_CROSSOVER:
+      for (unsigned int i = 0; i < edge_number; ++i) {
+        if (::util::random::RollPercentage(options_.crossover_father_bias)) {
+          set_bit(i);
+        }
+      }
+      break;
+    case Options::LAYER_CROSSOVER:
+      if (::util::random::RollPercentage(0.5)) {
+        for (uint32_t& word : *mask) {
+          word = ~0u;
+        }
+      }
+      break;
+    case Options::NODE_CROSSOVER:
+      // The incoming edges of a node are contiguous in the storage order.
+      for (unsigned int to = 0; to < next_layer_size; ++to) {
+        if (::util::random::RollPercentage(0.5)) {
+          for (unsigned int from = 0; from < layer_size; ++from) {
+            set_bit(from + to * layer_size);
+          }
+        }
+      }
+      break;
+    default:
+      throw "Unsupported crossover strategy.";
+  }
 }
 
 std::vector<SimpleNetwork::Edge> SimpleNetworkEvolver::RandomPath(
@@ -102,37 +204,50 @@ std::vector<SimpleNetwork::Edge> SimpleNetworkEvolver::RandomPath(
   return result;
 }
 
+void SimpleNetworkEvolver::SelectWeightMutations(
+    const SimpleNetwork& specimen) {
+  weight_mutations_.clear();
+  const double weight_chance = options_.mutation_weight_chance;
+  if (weight_chance <= 0.0) {
+    return;
+  }
+
+  // Each edge is mutated independently with the same chance. Instead of
+  // rolling for every edge, jump directly to the next mutated edge, so the
+  // cost only depends on the number of mutations.
+  const unsigned int edge_number = specimen.ExistingEdgeCount();
+  std::mt19937* const generator = ::util::random::StaticGenerator();
+  for (unsigned int i = 0; i < edge_number; ++i) {
+    if (weight_chance < 1.0) {
+      const unsigned int gap = weight_mutation_gap_(*generator);
+      if (gap >= edge_number - i) {
+        break;
+      }
+      i += gap;
+    }
+    weight_mutations_.push_back(specimen.ExistingEdge(i));
+  }
+}
+
 void SimpleNetworkEvolver::MutateGrowth(SimpleNetwork* specimen) {
-  // Use a weighted distribution to select the change in edge numbers.
-  const auto distribution_map_pair =
-      ::util::random::WeightedDistribution::FromMap(
-          options_.mutation_grow_probabilities);
-  ::util::random::WeightedDistribution distribution =
-      distribution_map_pair.first;
-  std::unordered_map<::util::random::WeightedDistribution::result_type, int>
-      back_map = distribution_map_pair.second;
-
-  const int growth = back_map[distribution(*::util::random::StaticGenerator())];
-  const std::function<void(SimpleNetworkEvolver*, SimpleNetwork*)>
-      remove_or_add = (growth < 0 ? &SimpleNetworkEvolver::RemoveRandomEdge
-                                  : &SimpleNetworkEvolver::AddRandomEdge);
+  const int growth =
+      growth_values_[growth_distribution_(*::util::random::StaticGenerator())];
   for (int i = 0; i < std::abs(growth); ++i) {
-    remove_or_add(this, specimen);
+    if (growth < 0) {
+      RemoveRandomEdge(specimen);
+    } else {
+      AddRandomEdge(specimen);
+    }
   }
 }
 
 void SimpleNetworkEvolver::AddRandomEdge(SimpleNetwork* specimen) {
   // Select random edge that does not exist.
-  const auto not_has_edge = [specimen](const SimpleNetwork::Edge& edge) {
-    return !specimen->HasConnection(edge);
-  };
-  const std::vector<SimpleNetwork::Edge> edges =
-      specimen->AllEdges(not_has_edge);
-  if (edges.empty()) {
+  if (specimen->MissingEdgeCount() == 0) {
     return;
   }
-  const SimpleNetwork::Edge edge =
-      *::util::random::RandomSequenceElement(edges.begin(), edges.end());
+  const SimpleNetwork::Edge edge = specimen->MissingEdge(
+      ::util::random::RandomInt(0, specimen->MissingEdgeCount() - 1));
 
   // Add the edge.
   specimen->AddConnection(edge, ::util::random::RandomDouble(-1.0, 1.0));
@@ -140,15 +255,11 @@ void SimpleNetworkEvolver::AddRandomEdge(SimpleNetwork* specimen) {
 
 void SimpleNetworkEvolver::RemoveRandomEdge(SimpleNetwork* specimen) {
   // Select random existing edge.
-  const auto has_edge = [specimen](const SimpleNetwork::Edge& edge) {
-    return specimen->HasConnection(edge);
-  };
-  const std::vector<SimpleNetwork::Edge> edges = specimen->AllEdges(has_edge);
-  if (edges.empty()) {
+  if (specimen->ExistingEdgeCount() == 0) {
     return;
   }
-  const SimpleNetwork::Edge edge =
-      *::util::random::RandomSequenceElement(edges.begin(), edges.end());
+  const SimpleNetwork::Edge edge = specimen->ExistingEdge(
+      ::util::random::RandomInt(0, specimen->ExistingEdgeCount() - 1));
 
   // Remove the edge.
   specimen->RemoveConnection(edge);
@@ -156,10 +267,8 @@ void SimpleNetworkEvolver::RemoveRandomEdge(SimpleNetwork* specimen) {
 
 void SimpleNetworkEvolver::MutateWeight(SimpleNetwork* specimen,
                                         const SimpleNetwork::Edge& edge) {
-  std::normal_distribution<double> normal_distribution(
-      0.0, options_.mutation_weight_stddev);
   const double weight_change =
-      normal_distribution(*::util::random::StaticGenerator());
+      weight_change_(*::util::random::StaticGenerator());
   const double new_weight = std::max(
       -1.0, std::min(1.0, specimen->ConnectionWeight(edge) + weight_change));
   specimen->AddConnection(edge, new_weight);
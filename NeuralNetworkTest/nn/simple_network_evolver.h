@@ -1,9 +1,13 @@
 #pragma once
 
 #include <map>
+#include <memory>
+#include <random>
 
 #include "evolution/evolver.h"
 #include "nn/simple_network.h"
+#include "util/memory/arena.h"
+#include "util/random/weighted_distribution.h"
 
 class SimpleNetworkEvolver : public Evolver<SimpleNetwork> {
  public:
@@ -11,6 +15,23 @@ class SimpleNetworkEvolver : public Evolver<SimpleNetwork> {
     // The layer sizes of the networks this evolver is creating.
     std::vector<int> layer_sizes;
 
+    // How the edges of two parents are combined when mating.
+    enum CrossoverStrategy {
+      // Each edge is copied from a random parent.
+      UNIFORM_CROSSOVER = 0,
+      // Like UNIFORM_CROSSOVER, but each edge is copied from the father with
+      // probability crossover_father_bias.
+      BIASED_UNIFORM_CROSSOVER = 1,
+      // All edges between two layers are copied from the same random parent.
+      LAYER_CROSSOVER = 2,
+      // All incoming edges of a node are copied from the same random parent.
+      NODE_CROSSOVER = 3
+    };
+    CrossoverStrategy crossover_strategy = UNIFORM_CROSSOVER;
+
+    // The chance of the father being selected for BIASED_UNIFORM_CROSSOVER.
+    double crossover_father_bias = 0.5;
+
     // The chance of a network to mutate by adding or removing an edge.
     double mutation_grow_chance = 0.0;
 
@@ -26,6 +47,13 @@ class SimpleNetworkEvolver : public Evolver<SimpleNetwork> {
     // weights on edges. The mean of the distribution is 0. The weights will
     // never leave the interval [-1,1].
     double mutation_weight_stddev = 1.0;
+
+    // Whether the children of a generation are allocated in an arena that is
+    // reset as a whole at the end of the generation. The survivors are
+    // compacted into a second arena. Networks created by Mate then stay valid
+    // only until the second EndGeneration after their creation; copy them to
+    // keep them. The storage of dead specimens is not reused in this mode.
+    bool use_generation_arena = false;
   };
 
   // Creates a new evolver which is working on networks of the given size.
@@ -38,12 +66,33 @@ class SimpleNetworkEvolver : public Evolver<SimpleNetwork> {
 
   SimpleNetwork Mutate(const SimpleNetwork& specimen) override;
 
+  // Reuses the storage of *out if it has the same layer sizes as the parents.
+  // Otherwise *out is rebuilt in the arena it is stored in.
+  void MateInto(const SimpleNetwork& father, const SimpleNetwork& mother,
+                SimpleNetwork* out) override;
+
+  void MutateInPlace(SimpleNetwork* specimen) override;
+
+  // Compacts the survivors into a fresh arena and releases the arena of the
+  // children if use_generation_arena is set.
+  void EndGeneration(std::vector<SimpleNetwork>* survivors,
+                     std::vector<SimpleNetwork>* dead) override;
+
  private:
+  // Fills the mask for SimpleNetwork::InheritLayer on a layer with the given
+  // number of nodes on it and on the next layer.
+  void CrossoverMask(unsigned int layer_size, unsigned int next_layer_size,
+                     std::vector<uint32_t>* mask) const;
+
   // Constructs a random path from node a to b.
   std::vector<SimpleNetwork::Edge> RandomPath(
       const SimpleNetwork& network, const SimpleNetwork::Node& from,
       const SimpleNetwork::Node& to) const;
 
+  // Selects the existing edges of the network whose weights are mutated and
+  // stores them in weight_mutations_.
+  void SelectWeightMutations(const SimpleNetwork& specimen);
+
   // Adds or removes edges from the network.
   void MutateGrowth(SimpleNetwork* specimen);
 
@@ -55,4 +104,24 @@ class SimpleNetworkEvolver : public Evolver<SimpleNetwork> {
   void MutateWeight(SimpleNetwork* specimen, const SimpleNetwork::Edge& edge);
 
   Options options_;
+
+  // Reused by Mate to avoid allocating a mask for every layer.
+  std::vector<uint32_t> crossover_mask_;
+
+  // The mutation plan, precomputed from the options. growth_values_ maps the
+  // results of growth_distribution_ to changes in the number of edges.
+  ::util::random::WeightedDistribution growth_distribution_;
+  std::vector<int> growth_values_;
+  std::geometric_distribution<unsigned int> weight_mutation_gap_;
+  std::normal_distribution<double> weight_change_;
+
+  // Reused by Mutate for the edges selected by SelectWeightMutations.
+  std::vector<SimpleNetwork::Edge> weight_mutations_;
+
+  // The arenas for use_generation_arena: the children of the current
+  // generation, the current survivors, and the arena the next survivors are
+  // compacted into.
+  std::unique_ptr<::util::memory::Arena> child_arena_;
+  std::unique_ptr<::util::memory::Arena> survivor_arena_;
+  std::unique_ptr<::util::memory::Arena> next_survivor_arena_;
 };
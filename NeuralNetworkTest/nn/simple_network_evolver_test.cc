@@ -1,5 +1,6 @@
 
 #include "nn/simple_network_evolver.h"
+#include "evolution/process.h"
 #include "gtest/gtest.h"
 
 namespace {
@@ -23,21 +24,33 @@ bool ConnectedFromInput(const SimpleNetwork& network,
   return false;
 }
 
+// Creates a network with all possible edges.
+SimpleNetwork CompleteNetwork(const std::vector<int>& layer_sizes) {
+  SimpleNetwork network(layer_sizes);
+  for (const SimpleNetwork::Edge& edge : network.AllEdges()) {
+    network.AddConnection(edge, 1.0);
+  }
+  return network;
+}
+
+// Mates a complete network with an empty one.
+SimpleNetwork MateCompleteAndEmpty(
+    const std::vector<int>& layer_sizes,
+    SimpleNetworkEvolver::Options::CrossoverStrategy crossover_strategy) {
+  SimpleNetworkEvolver::Options options;
+  options.crossover_strategy = crossover_strategy;
+  SimpleNetworkEvolver evolver(options);
+  return evolver.Mate(CompleteNetwork(layer_sizes),
+                      SimpleNetwork(layer_sizes));
+}
+
 // Creates a complete network with all edges and one with no edges and mates
 // them. The return value is the ratio of edges to non-edges in the offspring
 // which should converge against 1.
 double MateExperiment(int edges) {
-  // Create the parent networks.
-  const std::vector<int> layer_sizes{edges, 1};
-  SimpleNetwork complete_network(layer_sizes);
-  SimpleNetwork empty_network(layer_sizes);
-  for (const SimpleNetwork::Edge& edge : complete_network.AllEdges()) {
-    complete_network.AddConnection(edge, 1.0);
-  }
-
-  // Mate the two.
-  SimpleNetworkEvolver evolver((SimpleNetworkEvolver::Options()));
-  const SimpleNetwork offspring = evolver.Mate(complete_network, empty_network);
+  const SimpleNetwork offspring = MateCompleteAndEmpty(
+      std::vector<int>{edges, 1},
+      SimpleNetworkEvolver::Options::UNIFORM_CROSSOVER);
 
   // Calculate the experiment result.
   const auto has_edge = [&offspring](const SimpleNetwork::Edge& edge) {
@@ -50,6 +63,29 @@ double MateExperiment(int edges) {
   const int removed_edges = offspring.AllEdges(not_has_edge).size();
   return static_cast<double>(added_edges) / removed_edges;
 }
+
+// Mutates the weights of a complete network with weights 0 and returns the
+// ratio of edges whose weight changed.
+double MutateWeightExperiment(int edges, double mutation_weight_chance) {
+  SimpleNetwork network(std::vector<int>{edges, 1});
+  for (const SimpleNetwork::Edge& edge : network.AllEdges()) {
+    network.AddConnection(edge, 0.0);
+  }
+
+  SimpleNetworkEvolver::Options options;
+  options.mutation_weight_chance = mutation_weight_chance;
+  SimpleNetworkEvolver evolver(options);
+  const SimpleNetwork mutated_network = evolver.Mutate(network);
+
+  int mutated_edges = 0;
+  for (const SimpleNetwork::Edge& edge : mutated_network.AllEdges()) {
+    EXPECT_TRUE(mutated_network.HasConnection(edge));
+    if (mutated_network.ConnectionWeight(edge) != 0.0) {
+      ++mutated_edges;
+    }
+  }
+  return static_cast<double>(mutated_edges) / edges;
+}
 }
 
 #include <iostream>
@@ -98,6 +134,208 @@ TEST(SimpleNetworkEvolverTest, MateTest) {
   }
 }
 
+TEST(SimpleNetworkEvolverTest, LayerCrossoverTest) {
+  // Each layer has to be copied entirely from one parent.
+  for (int i = 0; i < 20; ++i) {
+    const SimpleNetwork offspring =
+        MateCompleteAndEmpty(std::vector<int>{3, 4, 2},
+                             SimpleNetworkEvolver::Options::LAYER_CROSSOVER);
+    for (unsigned int layer = 0; layer < 2; ++layer) {
+      const unsigned int edges = offspring.Edges(layer).size();
+      const unsigned int existing_edges =
+          offspring.Edges(layer, SimpleNetwork::EXISTING_EDGES).size();
+      EXPECT_TRUE(existing_edges == 0 || existing_edges == edges);
+    }
+    EXPECT_EQ(offspring.ExistingEdgeCount(), offspring.ExistingEdges().size());
+  }
+}
+
+TEST(SimpleNetworkEvolverTest, NodeCrossoverTest) {
+  // All incoming edges of a node have to be copied from the same parent.
+  for (int i = 0; i < 20; ++i) {
+    const SimpleNetwork offspring =
+        MateCompleteAndEmpty(std::vector<int>{3, 4, 2},
+                             SimpleNetworkEvolver::Options::NODE_CROSSOVER);
+    for (unsigned int layer = 1; layer < 3; ++layer) {
+      for (unsigned int to = 0; to < offspring.LayerSize(layer); ++to) {
+        const bool first_exists =
+            offspring.HasConnection(SimpleNetwork::Edge(layer - 1, 0, to));
+        for (unsigned int from = 0; from < offspring.LayerSize(layer - 1);
+             ++from) {
+          EXPECT_EQ(offspring.HasConnection(
+                        SimpleNetwork::Edge(layer - 1, from, to)),
+                    first_exists);
+        }
+      }
+    }
+  }
+}
+
+TEST(SimpleNetworkEvolverTest, MateIntoTest) {
+  const std::vector<int> layer_sizes{3, 4, 2};
+  const SimpleNetwork father = CompleteNetwork(layer_sizes);
+  const SimpleNetwork mother(layer_sizes);
+  SimpleNetworkEvolver::Options options;
+  options.crossover_strategy = SimpleNetworkEvolver::Options::LAYER_CROSSOVER;
+  SimpleNetworkEvolver evolver(options);
+
+  // Reuse both a network of the same shape with unrelated edges and a network
+  // of a different shape.
+  std::vector<SimpleNetwork> outs{CompleteNetwork(layer_sizes),
+                                  SimpleNetwork(std::vector<int>{2, 2})};
+  for (int i = 0; i < 20; ++i) {
+    for (SimpleNetwork& out : outs) {
+      evolver.MateInto(father, mother, &out);
+      ASSERT_EQ(out.LayerNumber(), 3);
+      for (unsigned int layer = 0; layer < 2; ++layer) {
+        const unsigned int edges = out.Edges(layer).size();
+        const unsigned int existing_edges =
+            out.Edges(layer, SimpleNetwork::EXISTING_EDGES).size();
+        EXPECT_TRUE(existing_edges == 0 || existing_edges == edges);
+      }
+      EXPECT_EQ(out.ExistingEdgeCount(), out.ExistingEdges().size());
+    }
+  }
+}
+
+TEST(SimpleNetworkEvolverTest, EndGenerationTest) {
+  const std::vector<int> layer_sizes{3, 4, 2};
+  const SimpleNetwork father = CompleteNetwork(layer_sizes);
+  const SimpleNetwork mother(layer_sizes);
+  SimpleNetworkEvolver::Options options;
+  options.use_generation_arena = true;
+  SimpleNetworkEvolver evolver(options);
+
+  for (int generation = 0; generation < 3; ++generation) {
+    std::vector<SimpleNetwork> children;
+    for (int i = 0; i < 10; ++i) {
+      children.push_back(evolver.Mate(father, mother));
+    }
+    ::util::memory::Arena* const child_arena = children.front().arena();
+    ASSERT_NE(child_arena, nullptr);
+
+    // Keep every other child.
+    std::vector<SimpleNetwork> survivors;
+    std::vector<SimpleNetwork> dead;
+    std::vector<unsigned int> edge_counts;
+    for (int i = 0; i < 10; ++i) {
+      if (i % 2 == 0) {
+        edge_counts.push_back(children[i].ExistingEdgeCount());
+        survivors.push_back(std::move(children[i]));
+      } else {
+        dead.push_back(std::move(children[i]));
+      }
+    }
+    evolver.EndGeneration(&survivors, &dead);
+
+    EXPECT_TRUE(dead.empty());
+    for (unsigned int i = 0; i < survivors.size(); ++i) {
+      EXPECT_NE(survivors[i].arena(), nullptr);
+      EXPECT_NE(survivors[i].arena(), child_arena);
+      EXPECT_EQ(survivors[i].ExistingEdgeCount(), edge_counts[i]);
+      EXPECT_EQ(survivors[i].ExistingEdges().size(), edge_counts[i]);
+    }
+  }
+}
+
+// Copies and moves networks between a generation in the arenas and on the heap.
+// Each network has to stay valid until the arena it is stored in is reset.
+TEST(SimpleNetworkEvolverTest, GenerationArenaAssignmentTest) {
+  const std::vector<int> layer_sizes{3, 4, 2};
+  const SimpleNetwork father = CompleteNetwork(layer_sizes);
+  const SimpleNetwork mother(layer_sizes);
+  const std::vector<double> input{1.0, 0.5, -0.5};
+  SimpleNetworkEvolver::Options options;
+  options.use_generation_arena = true;
+  options.mutation_weight_chance = 0.5;
+  SimpleNetworkEvolver evolver(options);
+
+  std::vector<SimpleNetwork> heap_networks;
+  for (int generation = 0; generation < 4; ++generation) {
+    std::vector<SimpleNetwork> survivors;
+    std::vector<SimpleNetwork> dead;
+    for (int i = 0; i < 6; ++i) {
+      survivors.push_back(evolver.Mate(father, mother));
+      evolver.MutateInPlace(&survivors.back());
+    }
+    if (!heap_networks.empty()) {
+      // Assigning heap networks to networks in the arena and back.
+      survivors[0] = heap_networks[1];
+      survivors[1] = std::move(heap_networks[2]);
+      dead.push_back(survivors[2]);
+      dead.push_back(std::move(survivors.back()));
+      survivors.pop_back();
+    }
+    evolver.EndGeneration(&survivors, &dead);
+
+    std::vector<std::vector<double>> outputs;
+    for (const SimpleNetwork& survivor : survivors) {
+      outputs.push_back(survivor.Forward(input));
+    }
+
+    // Copy and move assignment of whole generations.
+    std::vector<SimpleNetwork> copy;
+    copy = survivors;
+    std::vector<SimpleNetwork> moved;
+    moved = std::move(copy);
+    heap_networks = moved;
+    moved = survivors;
+    for (unsigned int i = 0; i < survivors.size(); ++i) {
+      EXPECT_EQ(heap_networks[i].arena(), nullptr);
+      EXPECT_EQ(heap_networks[i].Forward(input), outputs[i]);
+      EXPECT_EQ(moved[i].Forward(input), outputs[i]);
+    }
+  }
+}
+
+TEST(SimpleNetworkEvolverTest, GenerationArenaProcessTest) {
+  using SNProcess = Process<SimpleNetwork>;
+  SimpleNetworkEvolver::Options evolver_options;
+  evolver_options.layer_sizes = std::vector<int>{3, 4, 2};
+  evolver_options.mutation_grow_chance = 0.5;
+  evolver_options.mutation_weight_chance = 0.2;
+  evolver_options.use_generation_arena = true;
+  SimpleNetworkEvolver evolver(evolver_options);
+
+  SNProcess::Options options;
+  options.natural_selection_strategy = SNProcess::Options::KILL_PRECISE_WORST;
+  options.generation_size = 6;
+  options.offspring_count = 2;
+  options.evolution_terminate = SNProcess::TerminateAfterNGenerations(10);
+  const auto fitness = [](const SimpleNetwork& network) {
+    return network.Forward(std::vector<double>{1.0, 0.5, -0.5})[0];
+  };
+
+  const SNProcess::Generation result =
+      SNProcess::Evolution(&evolver, fitness, options);
+  ASSERT_EQ(result.size(), 6);
+  for (const SimpleNetwork& network : result) {
+    EXPECT_NE(network.arena(), nullptr);
+    EXPECT_EQ(network.LayerNumber(), 3);
+    EXPECT_EQ(network.ExistingEdges().size(), network.ExistingEdgeCount());
+  }
+}
+
 TEST(SimpleNetworkEvolverTest, MutateTest) {
-  // TODO
+  const int TEST_SIZE = 2000;
+  const double ERROR_ALLOWED = 0.02;
+  const int RETRIES = 5;
+
+  EXPECT_EQ(MutateWeightExperiment(TEST_SIZE, 0.0), 0.0);
+  EXPECT_EQ(MutateWeightExperiment(TEST_SIZE, 1.0), 1.0);
+
+  bool passed = false;
+  for (int i = 0; i < RETRIES; ++i) {
+    // See if this experiment run passes the error threshold.
+    const double mutated_ratio = MutateWeightExperiment(TEST_SIZE, 0.1);
+    const double error = std::abs(mutated_ratio - 0.1);
+    if (error <= ERROR_ALLOWED) {
+      passed = true;
+    }
+  }
+  if (!passed) {
+    FAIL() << "The ratio of mutated weights is not within the error threshold. "
+              "Try rerunning the test to see if you were just unlucky. If it "
+              "still fails, there might be a bug.";
+  }
 }
@@ -0,0 +1,358 @@
+
+#include "nn/simple_network_io.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "snowhouse/snowhouse.h"
+
+using namespace snowhouse;
+
+namespace simple_network_io {
+
+namespace {
+const char kMagic[4] = {'S', 'N', 'W', 'K'};
+
+// The size of the fixed part of the header, before the record offsets.
+const std::size_t kHeaderSize = 16;
+
+bool IsLittleEndian() {
+  const uint16_t value = 1;
+  unsigned char first_byte;
+  std::memcpy(&first_byte, &value, 1);
+  return first_byte == 1;
+}
+
+std::size_t AlignTo8(std::size_t offset) {
+  return (offset + 7) & ~std::size_t{7};
+}
+
+// Appends copies of the mapped networks to *networks. Returns false and
+// appends nothing if the resolver does not know an activation id.
+bool AppendNetworks(const MappedNetworks& mapped_networks,
+                    const ActivationResolver& resolver,
+                    ::util::memory::Arena* arena,
+                    std::vector<SimpleNetwork>* networks) {
+  for (unsigned int i = 0; i < mapped_networks.size(); ++i) {
+    if (!resolver(mapped_networks[i].activation())) {
+      return false;
+    }
+  }
+  for (unsigned int i = 0; i < mapped_networks.size(); ++i) {
+    networks->push_back(mapped_networks[i].ToNetwork(resolver, arena));
+  }
+  return true;
+}
+
+void AppendUint32(uint32_t value, std::string* buffer) {
+  for (int i = 0; i < 4; ++i) {
+    buffer->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+void AppendUint64(uint64_t value, std::string* buffer) {
+  for (int i = 0; i < 8; ++i) {
+    buffer->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+void WriteUint64At(std::size_t offset, uint64_t value, std::string* buffer) {
+  for (int i = 0; i < 8; ++i) {
+    (*buffer)[offset + i] = static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+}
+
+// Appends an array of 8 byte values. On little-endian machines, this is a
+// plain copy of the memory.
+template <typename T>
+void AppendArray(const T* values, std::size_t size, std::string* buffer) {
+  static_assert(sizeof(T) == 8, "Only 8 byte values are supported.");
+  if (IsLittleEndian()) {
+    buffer->append(reinterpret_cast<const char*>(values), size * sizeof(T));
+    return;
+  }
+  for (std::size_t i = 0; i < size; ++i) {
+    uint64_t bits;
+    std::memcpy(&bits, &values[i], sizeof(bits));
+    AppendUint64(bits, buffer);
+  }
+}
+
+uint32_t ReadUint32(const char* data) {
+  uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint64_t ReadUint64(const char* data) {
+  uint64_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+// Checks that the unused bits of the last connectivity word are clear and
+// that missing edges have weight 0, so that views can use all weights.
+bool ValidLayerData(const char* data, uint64_t edge_number) {
+  const uint64_t* const connectivity = reinterpret_cast<const uint64_t*>(data);
+  const double* const weights =
+      reinterpret_cast<const double*>(connectivity + (edge_number + 63) / 64);
+  if (edge_number % 64 != 0 &&
+      connectivity[edge_number / 64] >> (edge_number % 64) != 0) {
+    return false;
+  }
+  for (uint64_t i = 0; i < edge_number; ++i) {
+    if (!((connectivity[i / 64] >> (i % 64)) & 1) && weights[i] != 0.0) {
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+void WriteNetworks(const std::vector<const SimpleNetwork*>& networks,
+                   ActivationId activation, std::ostream* out) {
+  std::string buffer(kMagic, sizeof(kMagic));
+  AppendUint32(kSimpleNetworkFormatVersion, &buffer);
+  AppendUint64(networks.size(), &buffer);
+  buffer.resize(kHeaderSize + 8 * networks.size(), 0);
+
+  for (unsigned int i = 0; i < networks.size(); ++i) {
+    const SimpleNetwork& network = *networks[i];
+    WriteUint64At(kHeaderSize + 8 * i, buffer.size(), &buffer);
+    AppendUint32(activation, &buffer);
+    AppendUint32(network.LayerNumber(), &buffer);
+    for (unsigned int layer = 0; layer < network.LayerNumber(); ++layer) {
+      AppendUint32(network.LayerSize(layer), &buffer);
+    }
+    buffer.resize(AlignTo8(buffer.size()), 0);
+    for (unsigned int layer = 0; layer + 1 < network.LayerNumber(); ++layer) {
+      AppendArray(network.LayerConnectivity(layer),
+                  network.LayerConnectivityWords(layer), &buffer);
+      AppendArray(network.LayerWeights(layer),
+                  network.LayerSize(layer) * network.LayerSize(layer + 1),
+                  &buffer);
+    }
+  }
+  out->write(buffer.data(), buffer.size());
+}
+
+bool ReadNetworks(std::istream* in, const ActivationResolver& resolver,
+                  std::vector<SimpleNetwork>* networks,
+                  ::util::memory::Arena* arena) {
+  // Copy the stream into aligned memory and read it in place.
+  const std::string data((std::istreambuf_iterator<char>(*in)),
+                         std::istreambuf_iterator<char>());
+  std::vector<uint64_t> aligned_data((data.size() + 7) / 8);
+  std::memcpy(aligned_data.data(), data.data(), data.size());
+  MappedNetworks mapped_networks;
+  if (!mapped_networks.Parse(reinterpret_cast<const char*>(aligned_data.data()),
+                             data.size())) {
+    return false;
+  }
+  return AppendNetworks(mapped_networks, resolver, arena, networks);
+}
+
+bool SaveNetworks(const std::string& path,
+                  const std::vector<const SimpleNetwork*>& networks,
+                  ActivationId activation) {
+  std::ofstream out(path, std::ios::binary);
+  WriteNetworks(networks, activation, &out);
+  return static_cast<bool>(out);
+}
+
+bool LoadNetworks(const std::string& path, const ActivationResolver& resolver,
+                  std::vector<SimpleNetwork>* networks) {
+  MappedNetworks mapped_networks;
+  if (!mapped_networks.Open(path)) {
+    return false;
+  }
+  return AppendNetworks(mapped_networks, resolver, nullptr, networks);
+}
+
+unsigned int MappedNetworks::NetworkView::LayerSize(unsigned int layer) const {
+  try {
+    AssertThat(layer, IsLessThan(layer_number_));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  return ReadUint32(reinterpret_cast<const char*>(&layer_sizes_[layer]));
+}
+
+const uint64_t* MappedNetworks::NetworkView::LayerConnectivity(
+    unsigned int layer) const {
+  try {
+    AssertThat(layer, IsLessThan(layer_data_.size()));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  return reinterpret_cast<const uint64_t*>(layer_data_[layer]);
+}
+
+const double* MappedNetworks::NetworkView::LayerWeights(
+    unsigned int layer) const {
+  const unsigned int edge_number = LayerSize(layer) * LayerSize(layer + 1);
+  return reinterpret_cast<const double*>(LayerConnectivity(layer) +
+                                         (edge_number + 63) / 64);
+}
+
+bool MappedNetworks::NetworkView::HasConnection(
+    const SimpleNetwork::Edge& edge) const {
+  const unsigned int index =
+      edge.from.index + edge.to.index * LayerSize(edge.from.layer);
+  return (LayerConnectivity(edge.from.layer)[index / 64] >> (index % 64)) & 1;
+}
+
+double MappedNetworks::NetworkView::ConnectionWeight(
+    const SimpleNetwork::Edge& edge) const {
+  const unsigned int index =
+      edge.from.index + edge.to.index * LayerSize(edge.from.layer);
+  return LayerWeights(edge.from.layer)[index];
+}
+
+std::vector<double> MappedNetworks::NetworkView::Forward(
+    const std::vector<double>& input,
+    const ActivationFunction& activation) const {
+  try {
+    AssertThat(input.size(), Equals(LayerSize(0)));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  // Missing edges have weight 0, so all weights can be used.
+  std::vector<double> values = input;
+  std::vector<double> next_values;
+  for (unsigned int layer = 0; layer + 1 < layer_number_; ++layer) {
+    const unsigned int size = LayerSize(layer);
+    const unsigned int next_size = LayerSize(layer + 1);
+    const double* const weights = LayerWeights(layer);
+    next_values.assign(next_size, 0.0);
+    for (unsigned int to = 0; to < next_size; ++to) {
+      double sum = 0.0;
+      for (unsigned int from = 0; from < size; ++from) {
+        sum += values[from] * weights[from + to * size];
+      }
+      next_values[to] = activation(sum);
+    }
+    values.swap(next_values);
+  }
+  return values;
+}
+
+SimpleNetwork MappedNetworks::NetworkView::ToNetwork(
+    const ActivationResolver& resolver, ::util::memory::Arena* arena) const {
+  std::vector<int> layer_sizes;
+  for (unsigned int layer = 0; layer < layer_number_; ++layer) {
+    layer_sizes.push_back(LayerSize(layer));
+  }
+  SimpleNetwork network(layer_sizes, arena);
+  network.activation_function = resolver(activation_);
+  for (unsigned int layer = 0; layer + 1 < layer_number_; ++layer) {
+    network.SetLayer(layer, LayerConnectivity(layer), LayerWeights(layer));
+  }
+  return network;
+}
+
+MappedNetworks::~MappedNetworks() { Close(); }
+
+bool MappedNetworks::Open(const std::string& path) {
+  Close();
+  const int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(file, &file_stat) != 0 || file_stat.st_size == 0) {
+    close(file);
+    return false;
+  }
+  mapping_size_ = file_stat.st_size;
+  mapping_ = mmap(nullptr, mapping_size_, PROT_READ, MAP_PRIVATE, file, 0);
+  close(file);
+  if (mapping_ == MAP_FAILED) {
+    mapping_ = nullptr;
+    return false;
+  }
+  if (!Parse(static_cast<const char*>(mapping_), mapping_size_)) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+bool MappedNetworks::Parse(const char* data, std::size_t size) {
+  networks_.clear();
+  if (!IsLittleEndian() || reinterpret_cast<uintptr_t>(data) % 8 != 0) {
+    return false;
+  }
+
+  // Check the header.
+  if (size < kHeaderSize || std::memcmp(data, kMagic, sizeof(kMagic)) != 0 ||
+      ReadUint32(data + 4) != kSimpleNetworkFormatVersion) {
+    return false;
+  }
+  const uint64_t network_number = ReadUint64(data + 8);
+  if (network_number > (size - kHeaderSize) / 8) {
+    return false;
+  }
+
+  // Check each record and remember where its parts are.
+  std::vector<NetworkView> networks(network_number);
+  for (uint64_t i = 0; i < network_number; ++i) {
+    NetworkView& network = networks[i];
+    const uint64_t offset = ReadUint64(data + kHeaderSize + 8 * i);
+    if (offset % 8 != 0 || offset > size || size - offset < 8) {
+      return false;
+    }
+    network.activation_ = ReadUint32(data + offset);
+    network.layer_number_ = ReadUint32(data + offset + 4);
+    if (network.layer_number_ < 2 ||
+        network.layer_number_ > (size - offset - 8) / 4) {
+      return false;
+    }
+    network.layer_sizes_ = reinterpret_cast<const uint32_t*>(data + offset + 8);
+
+    uint64_t position = AlignTo8(offset + 8 + 4 * network.layer_number_);
+    for (unsigned int layer = 0; layer + 1 < network.layer_number_; ++layer) {
+      const uint64_t size1 = ReadUint32(data + offset + 8 + 4 * layer);
+      const uint64_t size2 = ReadUint32(data + offset + 12 + 4 * layer);
+      const uint64_t edge_number = size1 * size2;
+      if (size1 == 0 || size2 == 0 || edge_number > size ||
+          position > size) {
+        return false;
+      }
+      const uint64_t layer_bytes = 8 * ((edge_number + 63) / 64 + edge_number);
+      if (layer_bytes > size - position ||
+          !ValidLayerData(data + position, edge_number)) {
+        return false;
+      }
+      network.layer_data_.push_back(data + position);
+      position += layer_bytes;
+    }
+  }
+  networks_.swap(networks);
+  return true;
+}
+
+void MappedNetworks::Close() {
+  networks_.clear();
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+  }
+}
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "nn/simple_network.h"
+#include "util/memory/arena.h"
+
+// A binary format for lists of networks. All numbers are little-endian and
+// every array starts at a multiple of 8 bytes, so that a mapped file can be
+// read in place:
+//
+//   char[4]   magic "SNWK"
+//   uint32    format version (kSimpleNetworkFormatVersion)
+//   uint64    number of networks n
+//   uint64[n] byte offset of each network record from the start of the data
+//
+// Each network record:
+//   uint32    activation id
+//   uint32    number of layers L
+//   uint32[L] layer sizes, followed by padding to a multiple of 8 bytes
+//   for each layer l < L - 1, with E = size(l) * size(l + 1) edges:
+//     uint64[(E + 63) / 64]  connectivity bits, see LayerConnectivity
+//     double[E]              weights, see LayerWeights
+// Missing edges must have weight 0 and the unused connectivity bits must be
+// clear; data that breaks this is not valid.
+namespace simple_network_io {
+
+const uint32_t kSimpleNetworkFormatVersion = 1;
+
+// Activation functions cannot be stored, so the caller assigns ids to them
+// when writing and maps the ids back to functions when reading. A resolver
+// returns an empty function for ids it does not know, which makes reading
+// fail.
+using ActivationId = uint32_t;
+using ActivationFunction = std::function<double(double)>;
+using ActivationResolver = std::function<ActivationFunction(ActivationId)>;
+
+// Writes the networks to a stream. All networks get the same activation id.
+void WriteNetworks(const std::vector<const SimpleNetwork*>& networks,
+                   ActivationId activation, std::ostream* out);
+
+// Writes all networks of a container, e.g. a generation.
+template <typename ContainerT>
+void WritePopulation(const ContainerT& networks, ActivationId activation,
+                     std::ostream* out) {
+  std::vector<const SimpleNetwork*> pointers;
+  for (const SimpleNetwork& network : networks) {
+    pointers.push_back(&network);
+  }
+  WriteNetworks(pointers, activation, out);
+}
+
+// Reads all networks from a stream and appends them to *networks. The
+// networks are created in the given arena. Returns false and appends nothing
+// if the data is not valid or an activation id is unknown.
+bool ReadNetworks(std::istream* in, const ActivationResolver& resolver,
+                  std::vector<SimpleNetwork>* networks,
+                  ::util::memory::Arena* arena = nullptr);
+
+// Saves networks to a file or loads them from one. Return false on failure,
+// like ReadNetworks.
+bool SaveNetworks(const std::string& path,
+                  const std::vector<const SimpleNetwork*>& networks,
+                  ActivationId activation);
+bool LoadNetworks(const std::string& path, const ActivationResolver& resolver,
+                  std::vector<SimpleNetwork>* networks);
+
+// Networks in serialised form which are read in place, e.g. from a memory
+// mapped file. The data is validated once when it is opened; after that,
+// accessing a network does not parse or copy anything.
+class MappedNetworks {
+ public:
+  // A read-only view of one network inside the data.
+  class NetworkView {
+   public:
+    ActivationId activation() const { return activation_; }
+    unsigned int LayerNumber() const { return layer_number_; }
+    unsigned int LayerSize(unsigned int layer) const;
+
+    // The edge data in the format of SimpleNetwork::LayerConnectivity and
+    // SimpleNetwork::LayerWeights.
+    const uint64_t* LayerConnectivity(unsigned int layer) const;
+    const double* LayerWeights(unsigned int layer) const;
+
+    bool HasConnection(const SimpleNetwork::Edge& edge) const;
+    double ConnectionWeight(const SimpleNetwork::Edge& edge) const;
+
+    // Runs the network directly on the stored weights.
+    std::vector<double> Forward(const std::vector<double>& input,
+                                const ActivationFunction& activation) const;
+
+    // Copies the network into a SimpleNetwork.
+    SimpleNetwork ToNetwork(const ActivationResolver& resolver,
+                            ::util::memory::Arena* arena = nullptr) const;
+
+   private:
+    friend class MappedNetworks;
+
+    ActivationId activation_ = 0;
+    unsigned int layer_number_ = 0;
+    const uint32_t* layer_sizes_ = nullptr;
+
+    // The start of the data of each layer with outgoing edges.
+    std::vector<const char*> layer_data_;
+  };
+
+  MappedNetworks() = default;
+  ~MappedNetworks();
+  MappedNetworks(const MappedNetworks&) = delete;
+  MappedNetworks& operator=(const MappedNetworks&) = delete;
+
+  // Maps a file into memory. Returns false if it cannot be read or is not
+  // valid.
+  bool Open(const std::string& path);
+
+  // Uses data that is already in memory and outlives this object. data has to
+  // be aligned to 8 bytes. Returns false if the data is not valid, which is
+  // also the case on big-endian machines.
+  bool Parse(const char* data, std::size_t size);
+
+  unsigned int size() const { return networks_.size(); }
+  const NetworkView& operator[](unsigned int i) const { return networks_[i]; }
+
+ private:
+  // Unmaps the file, if there is one.
+  void Close();
+
+  void* mapping_ = nullptr;
+  std::size_t mapping_size_ = 0;
+  std::vector<NetworkView> networks_;
+};
+}
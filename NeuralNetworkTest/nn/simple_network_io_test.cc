@@ -0,0 +1,164 @@
+
+#include "nn/simple_network_io.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <sstream>
+
+#include "gtest/gtest.h"
+#include "nn/simple_network_testing.h"
+
+namespace simple_network_io {
+
+namespace {
+const ActivationId kIdentity = 0;
+const ActivationId kTanh = 1;
+
+ActivationFunction ResolveActivation(ActivationId activation) {
+  if (activation == kIdentity) {
+    return [](double x) { return x; };
+  }
+  if (activation == kTanh) {
+    return [](double x) { return std::tanh(x); };
+  }
+  return nullptr;
+}
+
+// Creates a network with 100 possible edges between the first two layers, so
+// that the connectivity spans two words.
+SimpleNetwork RandomNetwork(std::mt19937* generator) {
+  SimpleNetwork network =
+      simple_network_testing::RandomNetwork({10, 10, 3}, 0.4, generator);
+  network.activation_function = ResolveActivation(kTanh);
+  return network;
+}
+
+void ExpectSameNetwork(const SimpleNetwork& expected,
+                       const SimpleNetwork& actual) {
+  ASSERT_EQ(actual.LayerNumber(), expected.LayerNumber());
+  for (unsigned int layer = 0; layer < expected.LayerNumber(); ++layer) {
+    ASSERT_EQ(actual.LayerSize(layer), expected.LayerSize(layer));
+  }
+  for (const SimpleNetwork::Edge& edge : expected.AllEdges()) {
+    EXPECT_EQ(actual.HasConnection(edge), expected.HasConnection(edge));
+    EXPECT_EQ(actual.ConnectionWeight(edge), expected.ConnectionWeight(edge));
+  }
+  EXPECT_EQ(actual.ExistingEdgeCount(), expected.ExistingEdgeCount());
+  EXPECT_EQ(actual.Hash(), expected.Hash());
+  const std::vector<double> input(expected.LayerSize(0), 0.5);
+  EXPECT_EQ(actual.Forward(input), expected.Forward(input));
+}
+}
+
+TEST(SimpleNetworkIoTest, StreamTest) {
+  std::mt19937 generator(23);
+  const std::vector<SimpleNetwork> networks{RandomNetwork(&generator),
+                                            RandomNetwork(&generator)};
+  std::stringstream stream;
+  WritePopulation(networks, kTanh, &stream);
+
+  std::vector<SimpleNetwork> read_networks;
+  ASSERT_TRUE(ReadNetworks(&stream, &ResolveActivation, &read_networks));
+  ASSERT_EQ(read_networks.size(), 2);
+  ExpectSameNetwork(networks[0], read_networks[0]);
+  ExpectSameNetwork(networks[1], read_networks[1]);
+}
+
+TEST(SimpleNetworkIoTest, FileTest) {
+  std::mt19937 generator(29);
+  const SimpleNetwork network = RandomNetwork(&generator);
+  const std::string path = ::testing::TempDir() + "simple_network_io_test";
+  ASSERT_TRUE(SaveNetworks(path, {&network}, kTanh));
+
+  std::vector<SimpleNetwork> loaded_networks;
+  ASSERT_TRUE(LoadNetworks(path, &ResolveActivation, &loaded_networks));
+  ASSERT_EQ(loaded_networks.size(), 1);
+  ExpectSameNetwork(network, loaded_networks[0]);
+
+  // The mapped view works without a copy of the network.
+  MappedNetworks mapped_networks;
+  ASSERT_TRUE(mapped_networks.Open(path));
+  ASSERT_EQ(mapped_networks.size(), 1);
+  const MappedNetworks::NetworkView& view = mapped_networks[0];
+  EXPECT_EQ(view.activation(), kTanh);
+  for (const SimpleNetwork::Edge& edge : network.AllEdges()) {
+    EXPECT_EQ(view.HasConnection(edge), network.HasConnection(edge));
+    EXPECT_EQ(view.ConnectionWeight(edge), network.ConnectionWeight(edge));
+  }
+  const std::vector<double> input(10, -0.25);
+  const std::vector<double> expected_output = network.Forward(input);
+  const std::vector<double> actual_output =
+      view.Forward(input, ResolveActivation(view.activation()));
+  ASSERT_EQ(actual_output.size(), expected_output.size());
+  for (unsigned int i = 0; i < expected_output.size(); ++i) {
+    EXPECT_NEAR(actual_output[i], expected_output[i], 1e-12);
+  }
+  std::remove(path.c_str());
+}
+
+TEST(SimpleNetworkIoTest, InvalidDataTest) {
+  std::mt19937 generator(31);
+  const SimpleNetwork network = RandomNetwork(&generator);
+  std::stringstream stream;
+  WriteNetworks({&network}, kIdentity, &stream);
+  const std::string data = stream.str();
+
+  const auto parses = [](const std::string& bytes) {
+    std::vector<uint64_t> aligned((bytes.size() + 7) / 8);
+    std::copy(bytes.begin(), bytes.end(),
+              reinterpret_cast<char*>(aligned.data()));
+    MappedNetworks mapped_networks;
+    return mapped_networks.Parse(
+        reinterpret_cast<const char*>(aligned.data()), bytes.size());
+  };
+  EXPECT_TRUE(parses(data));
+  EXPECT_FALSE(parses(data.substr(0, data.size() - 1)));
+  EXPECT_FALSE(parses(data.substr(0, 10)));
+  std::string bad_magic = data;
+  bad_magic[0] = 'X';
+  EXPECT_FALSE(parses(bad_magic));
+  std::string bad_version = data;
+  bad_version[4] = 2;
+  EXPECT_FALSE(parses(bad_version));
+
+  // The first layer starts at byte 48 with two connectivity words, followed
+  // by the weights.
+  const std::size_t connectivity_offset = 48;
+  const std::size_t weights_offset = connectivity_offset + 16;
+  std::string unused_bit = data;
+  unused_bit[connectivity_offset + 15] |= 0x10;
+  EXPECT_FALSE(parses(unused_bit));
+  unsigned int missing = 0;
+  while (missing < 100 &&
+         network.HasConnection({{0, missing % 10}, {1, missing / 10}})) {
+    ++missing;
+  }
+  ASSERT_LT(missing, 100);
+  std::string weighted_missing_edge = data;
+  const double weight = 0.5;
+  std::memcpy(&weighted_missing_edge[weights_offset + 8 * missing], &weight,
+              sizeof(weight));
+  EXPECT_FALSE(parses(weighted_missing_edge));
+}
+
+TEST(SimpleNetworkIoTest, UnknownActivationTest) {
+  std::mt19937 generator(37);
+  const SimpleNetwork network = RandomNetwork(&generator);
+  const ActivationId kUnknown = 7;
+  std::stringstream stream;
+  WriteNetworks({&network, &network}, kUnknown, &stream);
+
+  std::vector<SimpleNetwork> read_networks;
+  EXPECT_FALSE(ReadNetworks(&stream, &ResolveActivation, &read_networks));
+  EXPECT_TRUE(read_networks.empty());
+
+  const std::string path =
+      ::testing::TempDir() + "simple_network_io_unknown_test";
+  ASSERT_TRUE(SaveNetworks(path, {&network}, kUnknown));
+  EXPECT_FALSE(LoadNetworks(path, &ResolveActivation, &read_networks));
+  EXPECT_TRUE(read_networks.empty());
+  std::remove(path.c_str());
+}
+}
@@ -0,0 +1,273 @@
+#include "nn/simple_network_population.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "snowhouse/snowhouse.h"
+
+using namespace snowhouse;
+
+SimpleNetworkPopulation::Workspace::Workspace(
+    const SimpleNetworkPopulation& population) {
+  const unsigned int max_layer_size = *std::max_element(
+      population.layer_sizes_.begin(), population.layer_sizes_.end());
+  front_.resize(max_layer_size);
+  back_.resize(max_layer_size);
+}
+
+unsigned int SimpleNetworkPopulation::View::LayerNumber() const {
+  return population_->layer_sizes_.size();
+}
+
+unsigned int SimpleNetworkPopulation::View::LayerSize(
+    unsigned int layer) const {
+  try {
+    AssertThat(layer, IsLessThan(LayerNumber()));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  return population_->layer_sizes_[layer];
+}
+
+bool SimpleNetworkPopulation::View::HasConnection(
+    const SimpleNetwork::Edge& edge) const {
+  const unsigned int index =
+      edge.from.index + edge.to.index * LayerSize(edge.from.layer);
+  return (LayerConnectivity(edge.from.layer)[index / 64] >> (index % 64)) & 1;
+}
+
+double SimpleNetworkPopulation::View::ConnectionWeight(
+    const SimpleNetwork::Edge& edge) const {
+  const unsigned int index =
+      edge.from.index + edge.to.index * LayerSize(edge.from.layer);
+  return LayerWeights(edge.from.layer)[index];
+}
+
+unsigned int SimpleNetworkPopulation::View::ExistingEdgeCount() const {
+  // The unused bits of the last word of each layer are 0.
+  const unsigned int word_number = population_->layer_word_offsets_.back();
+  const uint64_t* const words =
+      population_->connectivity_.data() + index_ * word_number;
+  unsigned int result = 0;
+  for (unsigned int word = 0; word < word_number; ++word) {
+    result += __builtin_popcountll(words[word]);
+  }
+  return result;
+}
+
+unsigned int SimpleNetworkPopulation::View::LayerConnectivityWords(
+    unsigned int layer) const {
+  try {
+    AssertThat(layer + 1, IsLessThan(LayerNumber()));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  return population_->layer_word_offsets_[layer + 1] -
+         population_->layer_word_offsets_[layer];
+}
+
+const uint64_t* SimpleNetworkPopulation::View::LayerConnectivity(
+    unsigned int layer) const {
+  try {
+    AssertThat(layer + 1, IsLessThan(LayerNumber()));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  return population_->connectivity_.data() +
+         index_ * population_->layer_word_offsets_.back() +
+         population_->layer_word_offsets_[layer];
+}
+
+const double* SimpleNetworkPopulation::View::LayerWeights(
+    unsigned int layer) const {
+  try {
+    AssertThat(layer + 1, IsLessThan(LayerNumber()));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  return population_->weights_.data() +
+         index_ * population_->layer_edge_offsets_.back() +
+         population_->layer_edge_offsets_[layer];
+}
+
+std::vector<double> SimpleNetworkPopulation::View::Forward(
+    const std::vector<double>& input) const {
+  try {
+    AssertThat(input.size(), Equals(LayerSize(0)));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  Workspace workspace(*population_);
+  std::vector<double> result(LayerSize(LayerNumber() - 1));
+  Forward(input.data(), result.data(), &workspace);
+  return result;
+}
+
+void SimpleNetworkPopulation::View::Forward(const double* input,
+                                            double* output,
+                                            Workspace* workspace) const {
+  // The same buffer scheme and summation order as the uncompiled
+  // SimpleNetwork::Forward. Missing edges have weight 0 there as well.
+  double* const buffers[2] = {workspace->front_.data(),
+                              workspace->back_.data()};
+  const unsigned int layer_number = LayerNumber();
+  const double* values = input;
+  for (unsigned int layer = 0; layer + 1 < layer_number; ++layer) {
+    const unsigned int size = LayerSize(layer);
+    const unsigned int next_size = LayerSize(layer + 1);
+    const double* const weights = LayerWeights(layer);
+    double* const next_values =
+        (layer + 2 == layer_number ? output : buffers[layer % 2]);
+    for (unsigned int to = 0; to < next_size; ++to) {
+      const double* const column = weights + to * size;
+      double sum = 0.0;
+      for (unsigned int from = 0; from < size; ++from) {
+        sum += values[from] * column[from];
+      }
+      next_values[to] = population_->activation_function(sum);
+    }
+    values = next_values;
+  }
+}
+
+SimpleNetwork SimpleNetworkPopulation::View::ToNetwork(
+    ::util::memory::Arena* arena) const {
+  const std::vector<int> layer_sizes(population_->layer_sizes_.begin(),
+                                     population_->layer_sizes_.end());
+  SimpleNetwork network(layer_sizes, arena);
+  network.activation_function = population_->activation_function;
+  for (unsigned int layer = 0; layer + 1 < LayerNumber(); ++layer) {
+    network.SetLayer(layer, LayerConnectivity(layer), LayerWeights(layer));
+  }
+  return network;
+}
+
+SimpleNetworkPopulation::SimpleNetworkPopulation(
+    const std::vector<int>& layer_sizes)
+    : layer_sizes_(layer_sizes.begin(), layer_sizes.end()) {
+  try {
+    AssertThat(layer_sizes.size(), IsGreaterThan(1u));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  layer_word_offsets_.push_back(0);
+  layer_edge_offsets_.push_back(0);
+  for (unsigned int layer = 0; layer + 1 < layer_sizes_.size(); ++layer) {
+    const unsigned int edge_number =
+        layer_sizes_[layer] * layer_sizes_[layer + 1];
+    layer_word_offsets_.push_back(layer_word_offsets_.back() +
+                                  (edge_number + 63) / 64);
+    layer_edge_offsets_.push_back(layer_edge_offsets_.back() + edge_number);
+  }
+}
+
+SimpleNetworkPopulation::View SimpleNetworkPopulation::operator[](
+    unsigned int i) const {
+  try {
+    AssertThat(i, IsLessThan(size_));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  return View(this, i);
+}
+
+void SimpleNetworkPopulation::Resize(unsigned int size) {
+  // Shrinking a vector keeps its capacity, so growing up to the old size
+  // again does not allocate. New elements are 0, i.e. missing edges.
+  connectivity_.resize(std::size_t{size} * layer_word_offsets_.back(), 0);
+  weights_.resize(std::size_t{size} * layer_edge_offsets_.back(), 0.0);
+  size_ = size;
+}
+
+void SimpleNetworkPopulation::Set(unsigned int i,
+                                  const SimpleNetwork& network) {
+  AssertSameShape(network);
+  try {
+    AssertThat(i, IsLessThan(size_));
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  uint64_t* const connectivity =
+      connectivity_.data() + i * layer_word_offsets_.back();
+  double* const weights = weights_.data() + i * layer_edge_offsets_.back();
+  for (unsigned int layer = 0; layer + 1 < layer_sizes_.size(); ++layer) {
+    const uint64_t* const layer_connectivity = network.LayerConnectivity(layer);
+    const double* const layer_weights = network.LayerWeights(layer);
+    std::copy(layer_connectivity,
+              layer_connectivity + network.LayerConnectivityWords(layer),
+              connectivity + layer_word_offsets_[layer]);
+    std::copy(layer_weights,
+              layer_weights + layer_sizes_[layer] * layer_sizes_[layer + 1],
+              weights + layer_edge_offsets_[layer]);
+  }
+}
+
+void SimpleNetworkPopulation::Assign(
+    const std::vector<SimpleNetwork>& networks) {
+  Resize(networks.size());
+  for (unsigned int i = 0; i < networks.size(); ++i) {
+    Set(i, networks[i]);
+  }
+  if (!networks.empty()) {
+    activation_function = networks.front().activation_function;
+  }
+}
+
+Process<SimpleNetwork>::BatchFitnessFunction
+SimpleNetworkPopulation::BatchFitness(
+    std::function<double(const View&)> fitness,
+    ::util::concurrency::ThreadPool* pool) {
+  return [this, fitness, pool](const std::vector<SimpleNetwork>& generation,
+                               std::vector<double>* scores) {
+    Assign(generation);
+    scores->resize(size_);
+    if (pool == nullptr) {
+      for (unsigned int i = 0; i < size_; ++i) {
+        (*scores)[i] = fitness((*this)[i]);
+      }
+      return;
+    }
+    ::util::concurrency::ParallelFor(pool, 0, size_, 1,
+                                     [this, &fitness, scores](int i) {
+                                       (*scores)[i] = fitness((*this)[i]);
+                                     });
+  };
+}
+
+void SimpleNetworkPopulation::AssertSameShape(
+    const SimpleNetwork& network) const {
+  try {
+    AssertThat(network.LayerNumber(), Equals(layer_sizes_.size()));
+    for (unsigned int i = 0; i < layer_sizes_.size(); ++i) {
+      AssertThat(network.LayerSize(i), Equals(layer_sizes_[i]));
+    }
+  } catch (const AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+}
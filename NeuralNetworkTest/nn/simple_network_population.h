@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "evolution/process.h"
+#include "nn/simple_network.h"
+#include "util/concurrency/thread_pool.h"
+#include "util/memory/arena.h"
+
+// The edges of many networks with the same shape in two contiguous slabs: one
+// for all connectivity bits and one for all weights. The data of each network
+// is stored layer by layer in the format of SimpleNetwork::LayerConnectivity
+// and SimpleNetwork::LayerWeights, one network after the other. Networks are
+// read through views with the read API of SimpleNetwork.
+//
+// A Process<SimpleNetwork> keeps evolving SimpleNetworks, since mating and
+// mutation work on them. BatchFitness packs each generation into a population
+// before it is scored, so that the fitness reads the slabs instead of the
+// separate allocations of the networks.
+class SimpleNetworkPopulation {
+ public:
+  // Scratch memory for View::Forward, analogous to SimpleNetwork::Workspace.
+  class Workspace {
+   public:
+    Workspace() = default;
+    explicit Workspace(const SimpleNetworkPopulation& population);
+
+   private:
+    friend class SimpleNetworkPopulation;
+
+    // The values of the inner layers alternate between these two buffers.
+    std::vector<double> front_;
+    std::vector<double> back_;
+  };
+
+  // A read-only view of one network. It is invalidated by any change to the
+  // size of the population.
+  class View {
+   public:
+    unsigned int LayerNumber() const;
+    unsigned int LayerSize(unsigned int layer) const;
+
+    bool HasConnection(const SimpleNetwork::Edge& edge) const;
+    double ConnectionWeight(const SimpleNetwork::Edge& edge) const;
+    unsigned int ExistingEdgeCount() const;
+
+    // Same as in SimpleNetwork.
+    unsigned int LayerConnectivityWords(unsigned int layer) const;
+    const uint64_t* LayerConnectivity(unsigned int layer) const;
+    const double* LayerWeights(unsigned int layer) const;
+
+    // Gives exactly the output of SimpleNetwork::Forward on the network that
+    // was stored, with the activation function of the population.
+    std::vector<double> Forward(const std::vector<double>& input) const;
+    void Forward(const double* input, double* output,
+                 Workspace* workspace) const;
+
+    // Copies the network into a SimpleNetwork.
+    SimpleNetwork ToNetwork(::util::memory::Arena* arena = nullptr) const;
+
+   private:
+    friend class SimpleNetworkPopulation;
+
+    View(const SimpleNetworkPopulation* population, unsigned int index)
+        : population_(population), index_(index) {}
+
+    const SimpleNetworkPopulation* population_;
+    unsigned int index_;
+  };
+
+  // Creates an empty population for networks with the given layer sizes.
+  explicit SimpleNetworkPopulation(const std::vector<int>& layer_sizes);
+
+  unsigned int size() const { return size_; }
+  View operator[](unsigned int i) const;
+
+  // Changes the number of networks. New networks have no edges. The slabs
+  // keep their memory when the population shrinks.
+  void Resize(unsigned int size);
+
+  // Copies a network with the shape of the population to position i.
+  void Set(unsigned int i, const SimpleNetwork& network);
+
+  // Replaces the population by copies of the networks and takes the
+  // activation function of the first one.
+  void Assign(const std::vector<SimpleNetwork>& networks);
+
+  // Returns a batch fitness function for Process<SimpleNetwork>, which assigns
+  // each generation to this population and evaluates the fitness on the
+  // views, in parallel if a pool is given. The population must outlive the
+  // process and must not be used elsewhere while it runs.
+  Process<SimpleNetwork>::BatchFitnessFunction BatchFitness(
+      std::function<double(const View&)> fitness,
+      ::util::concurrency::ThreadPool* pool = nullptr);
+
+  // Shared by all networks.
+  std::function<double(double)> activation_function = [](double x) {
+    return x;
+  };
+
+ private:
+  // Asserts that the network has the shape of the population.
+  void AssertSameShape(const SimpleNetwork& network) const;
+
+  std::vector<unsigned int> layer_sizes_;
+
+  // The start of the data of each layer inside the data of one network, and
+  // the total size of the data of one network as the last element.
+  std::vector<unsigned int> layer_word_offsets_;
+  std::vector<unsigned int> layer_edge_offsets_;
+
+  unsigned int size_ = 0;
+  std::vector<uint64_t> connectivity_;
+  std::vector<double> weights_;
+};
@@ -0,0 +1,145 @@
+#include "nn/simple_network_population.h"
+
+#include <cmath>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "nn/simple_network_evolver.h"
+#include "nn/simple_network_testing.h"
+
+namespace {
+// 100 possible edges between the first two layers, so that the connectivity
+// of that layer spans two words.
+const std::vector<int> kLayerSizes{10, 10, 3};
+
+std::vector<SimpleNetwork> RandomNetworks(int number,
+                                          std::mt19937* generator) {
+  std::vector<SimpleNetwork> networks;
+  for (int i = 0; i < number; ++i) {
+    networks.push_back(
+        simple_network_testing::RandomNetwork(kLayerSizes, 0.4, generator));
+    networks.back().activation_function = [](double x) { return std::tanh(x); };
+  }
+  return networks;
+}
+
+std::vector<double> TestInput() {
+  std::vector<double> input;
+  for (int i = 0; i < 10; ++i) {
+    input.push_back(0.3 * i - 1.0);
+  }
+  return input;
+}
+}
+
+TEST(SimpleNetworkPopulationTest, ViewTest) {
+  std::mt19937 generator(3);
+  const std::vector<SimpleNetwork> networks = RandomNetworks(5, &generator);
+  SimpleNetworkPopulation population(kLayerSizes);
+  population.Assign(networks);
+  ASSERT_EQ(population.size(), 5);
+
+  const std::vector<double> input = TestInput();
+  for (unsigned int i = 0; i < networks.size(); ++i) {
+    const SimpleNetwork& network = networks[i];
+    const SimpleNetworkPopulation::View view = population[i];
+    ASSERT_EQ(view.LayerNumber(), 3);
+    for (unsigned int layer = 0; layer < 3; ++layer) {
+      EXPECT_EQ(view.LayerSize(layer), network.LayerSize(layer));
+    }
+    EXPECT_EQ(view.LayerConnectivityWords(0), 2);
+    EXPECT_EQ(view.LayerConnectivityWords(1), 1);
+    for (const SimpleNetwork::Edge& edge : network.AllEdges()) {
+      EXPECT_EQ(view.HasConnection(edge), network.HasConnection(edge));
+      EXPECT_EQ(view.ConnectionWeight(edge), network.ConnectionWeight(edge));
+    }
+    EXPECT_EQ(view.ExistingEdgeCount(), network.ExistingEdgeCount());
+
+    // The views sum like the networks, so the outputs are exactly the same.
+    EXPECT_EQ(view.Forward(input), network.Forward(input));
+    const SimpleNetwork copy = view.ToNetwork();
+    EXPECT_EQ(copy.Hash(), network.Hash());
+    EXPECT_EQ(copy.Forward(input), network.Forward(input));
+  }
+}
+
+TEST(SimpleNetworkPopulationTest, SlabTest) {
+  std::mt19937 generator(5);
+  SimpleNetworkPopulation population(kLayerSizes);
+  population.Assign(RandomNetworks(4, &generator));
+
+  // The data of the networks follows each other without gaps.
+  const unsigned int word_number = 2 + 1;
+  const unsigned int edge_number = 10 * 10 + 10 * 3;
+  for (unsigned int i = 0; i + 1 < population.size(); ++i) {
+    EXPECT_EQ(population[i + 1].LayerConnectivity(0),
+              population[i].LayerConnectivity(0) + word_number);
+    EXPECT_EQ(population[i + 1].LayerWeights(0),
+              population[i].LayerWeights(0) + edge_number);
+    EXPECT_EQ(population[i].LayerConnectivity(1),
+              population[i].LayerConnectivity(0) + 2);
+    EXPECT_EQ(population[i].LayerWeights(1),
+              population[i].LayerWeights(0) + 10 * 10);
+  }
+
+  // A smaller generation reuses the slabs, and new networks have no edges.
+  const double* const weights = population[0].LayerWeights(0);
+  population.Assign(RandomNetworks(2, &generator));
+  EXPECT_EQ(population[0].LayerWeights(0), weights);
+  population.Resize(3);
+  EXPECT_EQ(population[0].LayerWeights(0), weights);
+  EXPECT_EQ(population[2].ExistingEdgeCount(), 0);
+  EXPECT_EQ(population[2].Forward(TestInput()),
+            std::vector<double>(3, std::tanh(0.0)));
+}
+
+TEST(SimpleNetworkPopulationTest, BatchFitnessTest) {
+  std::mt19937 generator(7);
+  const std::vector<SimpleNetwork> networks = RandomNetworks(6, &generator);
+  const std::vector<double> input = TestInput();
+  const auto fitness = [&input](const SimpleNetworkPopulation::View& view) {
+    return view.Forward(input)[0];
+  };
+
+  SimpleNetworkPopulation population(kLayerSizes);
+  util::concurrency::ThreadPool pool(2);
+  const std::vector<util::concurrency::ThreadPool*> pools{nullptr, &pool};
+  for (util::concurrency::ThreadPool* batch_pool : pools) {
+    std::vector<double> scores;
+    population.BatchFitness(fitness, batch_pool)(networks, &scores);
+    ASSERT_EQ(scores.size(), networks.size());
+    for (unsigned int i = 0; i < networks.size(); ++i) {
+      EXPECT_EQ(scores[i], networks[i].Forward(input)[0]);
+    }
+  }
+}
+
+TEST(SimpleNetworkPopulationTest, ProcessTest) {
+  using SNProcess = Process<SimpleNetwork>;
+  SimpleNetworkEvolver::Options evolver_options;
+  evolver_options.layer_sizes = kLayerSizes;
+  evolver_options.mutation_grow_chance = 0.5;
+  evolver_options.mutation_weight_chance = 0.2;
+  SimpleNetworkEvolver evolver(evolver_options);
+
+  const std::vector<double> input = TestInput();
+  const auto fitness = [&input](const SimpleNetworkPopulation::View& view) {
+    return view.Forward(input)[0];
+  };
+  SimpleNetworkPopulation population(kLayerSizes);
+  util::concurrency::ThreadPool pool(2);
+  SNProcess::Options options;
+  options.natural_selection_strategy = SNProcess::Options::KILL_PRECISE_WORST;
+  options.generation_size = 6;
+  options.offspring_count = 2;
+  options.evolution_terminate = SNProcess::TerminateAfterNGenerations(10);
+  options.batch_fitness_function = population.BatchFitness(fitness, &pool);
+
+  // The fitness function is not used when there is a batch fitness function.
+  const SNProcess::Generation result = SNProcess::Evolution(
+      &evolver, [](const SimpleNetwork&) { return 0.0; }, options);
+  ASSERT_EQ(result.size(), 6);
+  for (unsigned int i = 0; i + 1 < result.size(); ++i) {
+    EXPECT_GE(result[i].Forward(input)[0], result[i + 1].Forward(input)[0]);
+  }
+}
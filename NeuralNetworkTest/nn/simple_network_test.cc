@@ -1,15 +1,17 @@
 
 #include "simple_network.h"
 
+#include <random>
+
 #include "gtest/gtest.h"
+#include "nn/simple_network_testing.h"
 
 class SimpleNetworkTest : public ::testing::Test {
  protected:
   SimpleNetwork test_network_1() {
     SimpleNetwork network(std::vector<int>{1, 2, 3});
-    network.layers_[0].connectivity_matrix(0, 0) = 1;
-    network.layers_[1].connectivity_matrix(1, 2) = 1;
-    network.layers_[1].weight_matrix(1, 2) = 0.5;
+    network.AddConnection(SimpleNetwork::Edge(0, 0, 0));
+    network.AddConnection(SimpleNetwork::Edge(1, 1, 2), 0.5);
     return network;
   }
 
@@ -40,6 +42,16 @@ class SimpleNetworkTest : public ::testing::Test {
     return network;
   }
 
+  // A network with random edges. For low densities, many nodes are not
+  // connected to the input or the output.
+  SimpleNetwork random_network(std::mt19937* generator, double density) {
+    SimpleNetwork network = simple_network_testing::RandomNetwork(
+        std::vector<int>{6, 8, 8, 5}, density, generator);
+    network.AddConnection(SimpleNetwork::Edge(1, 2, 3));
+    network.activation_function = [](double x) { return 0.5 * x + 0.25; };
+    return network;
+  }
+
   // Sets up the network and input and output vectors for ForwardTest.
   void ForwardTestSetup(double a, double b) {
     const SimpleNetwork network = test_network_2();
@@ -60,6 +72,12 @@ class SimpleNetworkTest : public ::testing::Test {
     ASSERT_EQ(actual_output.size(), 1);
     EXPECT_DOUBLE_EQ(actual_output[0], expected_output);
   }
+
+  // Checks whether two networks share the storage of a layer.
+  static bool SharesLayer(const SimpleNetwork& lhs, const SimpleNetwork& rhs,
+                          unsigned int layer) {
+    return lhs.layers_[layer] == rhs.layers_[layer];
+  }
 };
 
 TEST_F(SimpleNetworkTest, LayerNumberTest) {
@@ -162,6 +180,91 @@ TEST_F(SimpleNetworkTest, RemoveConnectionTest) {
   EXPECT_EQ(network.ConnectionWeight(edge3), 0.5);
 }
 
+TEST_F(SimpleNetworkTest, EdgeRangeTest) {
+  const SimpleNetwork network = test_network_1();
+  EXPECT_EQ(network.Edges().size(), 8);
+  EXPECT_EQ(network.Edges(0).size(), 2);
+  EXPECT_EQ(network.Edges(1).size(), 6);
+  EXPECT_EQ(network.MissingEdges().size(), 6);
+  EXPECT_EQ(network.Edges(1, SimpleNetwork::MISSING_EDGES).size(), 5);
+  EXPECT_TRUE(network.Edges(0, SimpleNetwork::MISSING_EDGES).begin() !=
+              network.Edges(0, SimpleNetwork::MISSING_EDGES).end());
+
+  // Only the two existing edges are visited.
+  std::vector<SimpleNetwork::Edge> existing_edges;
+  for (const SimpleNetwork::Edge& edge : network.ExistingEdges()) {
+    existing_edges.push_back(edge);
+  }
+  ASSERT_EQ(existing_edges.size(), 2);
+  EXPECT_EQ(existing_edges[0].from.layer, 0);
+  EXPECT_EQ(existing_edges[0].from.index, 0);
+  EXPECT_EQ(existing_edges[0].to.index, 0);
+  EXPECT_EQ(existing_edges[1].from.layer, 1);
+  EXPECT_EQ(existing_edges[1].from.index, 1);
+  EXPECT_EQ(existing_edges[1].to.index, 2);
+
+  // An empty filtered range.
+  const SimpleNetwork empty_network(std::vector<int>{2, 2});
+  EXPECT_TRUE(empty_network.ExistingEdges().empty());
+  EXPECT_EQ(empty_network.MissingEdges().size(), 4);
+}
+
+TEST_F(SimpleNetworkTest, EdgeCountTest) {
+  SimpleNetwork network = test_network_1();
+  EXPECT_EQ(network.ExistingEdgeCount(), 2);
+  EXPECT_EQ(network.MissingEdgeCount(), 6);
+
+  network.AddConnection(SimpleNetwork::Edge(1, 0, 1), 1.0);
+  network.AddConnection(SimpleNetwork::Edge(1, 0, 1), -1.0);
+  network.RemoveConnection(SimpleNetwork::Edge(0, 0, 0));
+  network.RemoveConnection(SimpleNetwork::Edge(0, 0, 1));
+  EXPECT_EQ(network.ExistingEdgeCount(), 2);
+  EXPECT_EQ(network.MissingEdgeCount(), 6);
+
+  // The indexed edges have to be exactly the existing/missing ones.
+  for (unsigned int i = 0; i < network.ExistingEdgeCount(); ++i) {
+    EXPECT_TRUE(network.HasConnection(network.ExistingEdge(i)));
+  }
+  for (unsigned int i = 0; i < network.MissingEdgeCount(); ++i) {
+    EXPECT_FALSE(network.HasConnection(network.MissingEdge(i)));
+  }
+  const SimpleNetwork::Edge first = network.ExistingEdge(0);
+  const SimpleNetwork::Edge second = network.ExistingEdge(1);
+  EXPECT_FALSE(first.from.index == second.from.index &&
+               first.to.index == second.to.index);
+}
+
+TEST_F(SimpleNetworkTest, EdgeComparisonTest) {
+  // A layer with 130 possible edges spans three connectivity words.
+  std::mt19937 generator(19);
+  const std::vector<int> layer_sizes{10, 13};
+  const SimpleNetwork lhs =
+      simple_network_testing::RandomNetwork(layer_sizes, 0.3, &generator);
+  const SimpleNetwork rhs =
+      simple_network_testing::RandomNetwork(layer_sizes, 0.3, &generator);
+  unsigned int common_edges = 0;
+  unsigned int different_edges = 0;
+  for (const SimpleNetwork::Edge& edge : lhs.AllEdges()) {
+    const bool in_lhs = lhs.HasConnection(edge);
+    const bool in_rhs = rhs.HasConnection(edge);
+    common_edges += (in_lhs && in_rhs);
+    different_edges += (in_lhs != in_rhs);
+  }
+  EXPECT_EQ(lhs.CommonEdgeCount(rhs), common_edges);
+  EXPECT_EQ(lhs.EdgeDistance(rhs), different_edges);
+  EXPECT_EQ(lhs.EdgeDistance(lhs), 0);
+
+  // The filtered views have to agree with the counts.
+  EXPECT_EQ(lhs.ExistingEdges().size(), lhs.ExistingEdgeCount());
+  EXPECT_EQ(lhs.MissingEdges().size(), lhs.MissingEdgeCount());
+  unsigned int visited_edges = 0;
+  for (const SimpleNetwork::Edge& edge : lhs.MissingEdges()) {
+    EXPECT_FALSE(lhs.HasConnection(edge));
+    ++visited_edges;
+  }
+  EXPECT_EQ(visited_edges, lhs.MissingEdgeCount());
+}
+
 TEST_F(SimpleNetworkTest, ForwardTest_1) { ForwardTestSetup(0.0, 0.0); }
 
 TEST_F(SimpleNetworkTest, ForwardTest_2) { ForwardTestSetup(1.0, 0.0); }
@@ -172,6 +275,247 @@ TEST_F(SimpleNetworkTest, ForwardTest_4) { ForwardTestSetup(0.5, -0.5); }
 
 TEST_F(SimpleNetworkTest, ForwardTest_5) { ForwardTestSetup(-0.4, 0.4); }
 
+TEST_F(SimpleNetworkTest, ForwardWorkspaceTest) {
+  // One workspace is reused for several inputs and networks of equal shape.
+  const SimpleNetwork network = test_network_2();
+  SimpleNetwork::Workspace workspace(network);
+  const std::vector<std::pair<double, double>> inputs{
+      {0.0, 0.0}, {1.0, 0.0}, {0.5, -0.5}, {-0.4, 0.4}};
+  for (const std::pair<double, double>& ab : inputs) {
+    const double a = ab.first, b = ab.second;
+    const double input[2] = {a, b};
+    double output[2] = {0.0, 0.0};
+    network.Forward(input, output, &workspace);
+    EXPECT_DOUBLE_EQ(output[0], a / 2 + b / 2);
+    EXPECT_DOUBLE_EQ(output[1], 2 * a + b);
+  }
+
+  // The workspace of a larger network also fits a smaller one.
+  const SimpleNetwork small_network = test_network_3();
+  const double input[2] = {0.4, 0.7};
+  double output = 0.0;
+  small_network.Forward(input, &output, &workspace);
+  EXPECT_DOUBLE_EQ(output, 0.4 - 0.7);
+}
+
+TEST_F(SimpleNetworkTest, SparseForwardTest) {
+  const SimpleNetwork network = test_network_2();
+  SimpleNetwork::Workspace workspace(network);
+  double output[2] = {0.0, 0.0};
+
+  network.Forward(std::vector<SimpleNetwork::SparseInput>{}, output,
+                  &workspace);
+  EXPECT_DOUBLE_EQ(output[0], 0.0);
+  EXPECT_DOUBLE_EQ(output[1], 0.0);
+
+  network.Forward(std::vector<SimpleNetwork::SparseInput>{{1, -0.5}}, output,
+                  &workspace);
+  EXPECT_DOUBLE_EQ(output[0], -0.25);
+  EXPECT_DOUBLE_EQ(output[1], -0.5);
+
+  network.Forward(std::vector<SimpleNetwork::SparseInput>{{1, 0.4}, {0, -0.4}},
+                  output, &workspace);
+  EXPECT_DOUBLE_EQ(output[0], 0.0);
+  EXPECT_DOUBLE_EQ(output[1], 2 * -0.4 + 0.4);
+
+  // Without inner layers the activation function is applied to the output.
+  const SimpleNetwork small_network = test_network_3();
+  small_network.Forward(std::vector<SimpleNetwork::SparseInput>{{0, 0.4}},
+                        output, &workspace);
+  EXPECT_DOUBLE_EQ(output[0], 0.4);
+}
+
+TEST_F(SimpleNetworkTest, CompileTest) {
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> input_value(-1.0, 1.0);
+  // A different summation order only changes the result now and then, so
+  // many networks are checked.
+  for (int i = 0; i < 2000; ++i) {
+    SimpleNetwork network = random_network(&generator, i % 2 ? 0.15 : 0.7);
+
+    // Some components are 0, so that the sparse input leaves them out.
+    std::vector<double> input(6);
+    std::vector<SimpleNetwork::SparseInput> sparse_input;
+    for (unsigned int j = 0; j < input.size(); ++j) {
+      input[j] = (j % 3 == 1 ? 0.0 : input_value(generator));
+      if (input[j] != 0.0) {
+        sparse_input.push_back(SimpleNetwork::SparseInput{j, input[j]});
+      }
+    }
+    const std::vector<double> expected_output = network.Forward(input);
+
+    // The compiled plan sums in the same order, so the outputs have to be
+    // exactly those of the full network, also for sparse inputs.
+    network.Compile();
+    ASSERT_TRUE(network.IsCompiled());
+    EXPECT_EQ(network.Forward(input), expected_output);
+    SimpleNetwork::Workspace workspace(network);
+    std::vector<double> sparse_output(expected_output.size());
+    network.Forward(sparse_input, sparse_output.data(), &workspace);
+    EXPECT_EQ(sparse_output, expected_output);
+
+    // Changing the network discards the plan.
+    network.AddConnection(SimpleNetwork::Edge(0, 0, 0), 0.5);
+    EXPECT_FALSE(network.IsCompiled());
+  }
+}
+
+TEST_F(SimpleNetworkTest, ForwardBatchTest) {
+  std::mt19937 generator(13);
+  std::uniform_real_distribution<double> input_value(-1.0, 1.0);
+  const unsigned int batch_size = 5;
+  for (int i = 0; i < 20; ++i) {
+    SimpleNetwork network = random_network(&generator, i % 2 ? 0.15 : 0.7);
+    const unsigned int input_size = network.LayerSize(0);
+    const unsigned int output_size =
+        network.LayerSize(network.LayerNumber() - 1);
+    std::vector<double> inputs(batch_size * input_size);
+    for (double& value : inputs) {
+      value = input_value(generator);
+    }
+
+    // Every row has to equal a single Forward call, with and without a plan.
+    for (int compiled = 0; compiled < 2; ++compiled) {
+      if (compiled) {
+        network.Compile();
+      }
+      SimpleNetwork::Workspace workspace(network, batch_size);
+      std::vector<double> outputs(batch_size * output_size);
+      network.ForwardBatch(inputs.data(), batch_size, outputs.data(),
+                           &workspace);
+      for (unsigned int b = 0; b < batch_size; ++b) {
+        std::vector<double> output(output_size);
+        network.Forward(inputs.data() + b * input_size, output.data(),
+                        &workspace);
+        for (unsigned int j = 0; j < output_size; ++j) {
+          EXPECT_EQ(outputs[b * output_size + j], output[j]);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(SimpleNetworkTest, ArenaTest) {
+  std::mt19937 generator(11);
+  const SimpleNetwork network = random_network(&generator, 0.5);
+  const std::vector<double> input{0.1, -0.2, 0.3, -0.4, 0.5, -0.6};
+
+  ::util::memory::Arena arena;
+  SimpleNetwork in_arena(network, &arena);
+  EXPECT_EQ(in_arena.arena(), &arena);
+  EXPECT_GT(arena.BytesUsed(), 0);
+  EXPECT_EQ(in_arena.Forward(input), network.Forward(input));
+  EXPECT_EQ(in_arena.ExistingEdgeCount(), network.ExistingEdgeCount());
+
+  // Plain copies leave the arena, moves keep it.
+  const SimpleNetwork copy = in_arena;
+  EXPECT_EQ(copy.arena(), nullptr);
+  const SimpleNetwork moved = std::move(in_arena);
+  EXPECT_EQ(moved.arena(), &arena);
+  EXPECT_EQ(moved.Forward(input), network.Forward(input));
+
+  SimpleNetwork empty(std::vector<int>{2, 3}, &arena);
+  empty.AddConnection(SimpleNetwork::Edge(0, 1, 2), 0.5);
+  EXPECT_EQ(empty.ExistingEdgeCount(), 1);
+}
+
+TEST_F(SimpleNetworkTest, CopyOnWriteTest) {
+  std::mt19937 generator(13);
+  const SimpleNetwork network = random_network(&generator, 0.5);
+  const std::vector<double> input{0.1, -0.2, 0.3, -0.4, 0.5, -0.6};
+  const std::vector<double> expected_output = network.Forward(input);
+
+  // Changing a copy only copies the changed layer.
+  SimpleNetwork copy = network;
+  for (unsigned int layer = 0; layer < 3; ++layer) {
+    EXPECT_TRUE(SharesLayer(network, copy, layer));
+  }
+  copy.AddConnection(SimpleNetwork::Edge(1, 0, 0), 0.75);
+  EXPECT_TRUE(SharesLayer(network, copy, 0));
+  EXPECT_FALSE(SharesLayer(network, copy, 1));
+  EXPECT_TRUE(SharesLayer(network, copy, 2));
+  EXPECT_EQ(network.Forward(input), expected_output);
+  EXPECT_EQ(copy.ConnectionWeight(SimpleNetwork::Edge(1, 0, 0)), 0.75);
+
+  // The edge index is shared as well.
+  copy.RemoveConnection(copy.ExistingEdge(0));
+  EXPECT_EQ(copy.ExistingEdgeCount() + 1, network.ExistingEdgeCount());
+  EXPECT_EQ(network.ExistingEdges().size(), network.ExistingEdgeCount());
+
+  // Networks in an arena do not share layers with heap networks.
+  ::util::memory::Arena arena;
+  const SimpleNetwork in_arena(network, &arena);
+  EXPECT_FALSE(SharesLayer(network, in_arena, 0));
+}
+
+TEST_F(SimpleNetworkTest, HashTest) {
+  std::mt19937 generator(17);
+  const SimpleNetwork network = random_network(&generator, 0.5);
+  ::util::memory::Arena arena;
+  SimpleNetwork copy(network, &arena);
+  EXPECT_EQ(copy.Hash(), network.Hash());
+
+  copy.AddConnection(SimpleNetwork::Edge(2, 1, 1), 0.125);
+  const std::size_t changed_hash = copy.Hash();
+  EXPECT_NE(changed_hash, network.Hash());
+  copy.AddConnection(SimpleNetwork::Edge(2, 1, 1),
+                     network.ConnectionWeight(SimpleNetwork::Edge(2, 1, 1)));
+  if (!network.HasConnection(SimpleNetwork::Edge(2, 1, 1))) {
+    copy.RemoveConnection(SimpleNetwork::Edge(2, 1, 1));
+  }
+  EXPECT_EQ(copy.Hash(), network.Hash());
+}
+
+TEST_F(SimpleNetworkTest, AccumulatorTest) {
+  const SimpleNetwork network = test_network_2();
+  SimpleNetwork::Workspace workspace(network);
+  const double input[2] = {0.5, -0.5};
+  SimpleNetwork::Accumulator accumulator(&network, input);
+
+  // Checks the accumulator output against a regular forward pass. Updates are
+  // applied as differences, so small rounding errors are allowed.
+  const auto expect_output = [&](double a, double b) {
+    double output[2] = {0.0, 0.0};
+    accumulator.Forward(output, &workspace);
+    EXPECT_NEAR(output[0], a / 2 + b / 2, 1e-12);
+    EXPECT_NEAR(output[1], 2 * a + b, 1e-12);
+  };
+
+  expect_output(0.5, -0.5);
+  accumulator.Push(0, 1.0);
+  expect_output(1.0, -0.5);
+  accumulator.Push(1, 0.0);
+  expect_output(1.0, 0.0);
+  EXPECT_EQ(accumulator.Input(0), 1.0);
+  EXPECT_EQ(accumulator.Input(1), 0.0);
+  accumulator.Pop();
+  expect_output(1.0, -0.5);
+  accumulator.Push(0, -0.4);
+  accumulator.Push(1, 0.4);
+  expect_output(-0.4, 0.4);
+  accumulator.Pop();
+  accumulator.Pop();
+  accumulator.Pop();
+  expect_output(0.5, -0.5);
+  EXPECT_EQ(accumulator.Input(0), 0.5);
+  EXPECT_EQ(accumulator.Input(1), -0.5);
+}
+
+TEST_F(SimpleNetworkTest, AccumulatorActivationFunctionTest) {
+  // Without inner layers the cached pre-activations belong to the output.
+  const SimpleNetwork network = test_network_3();
+  SimpleNetwork::Workspace workspace(network);
+  const double input[2] = {0.2, 0.0};
+  SimpleNetwork::Accumulator accumulator(&network, input);
+  double output = 0.0;
+  accumulator.Push(1, 0.7);
+  accumulator.Forward(&output, &workspace);
+  EXPECT_NEAR(output, 0.2 - 0.7, 1e-12);
+  accumulator.Pop();
+  accumulator.Forward(&output, &workspace);
+  EXPECT_NEAR(output, 0.2, 1e-12);
+}
+
 TEST_F(SimpleNetworkTest, ActivationFunctionTest_1) {
   ActivationFunctionTestSetup(0.4, 0.7);
 }
@@ -0,0 +1,18 @@
+
+#include "nn/simple_network_testing.h"
+
+namespace simple_network_testing {
+
+SimpleNetwork RandomNetwork(const std::vector<int>& layer_sizes, double density,
+                            std::mt19937* generator) {
+  std::bernoulli_distribution has_edge(density);
+  std::uniform_real_distribution<double> weight(-1.0, 1.0);
+  SimpleNetwork network(layer_sizes);
+  for (const SimpleNetwork::Edge& edge : network.AllEdges()) {
+    if (has_edge(*generator)) {
+      network.AddConnection(edge, weight(*generator));
+    }
+  }
+  return network;
+}
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <random>
+#include <vector>
+
+#include "nn/simple_network.h"
+
+// Helpers for tests of code that works on networks.
+namespace simple_network_testing {
+
+// Creates a network with the given layer sizes in which every possible edge
+// exists with probability density and has a uniform weight in [-1, 1].
+SimpleNetwork RandomNetwork(const std::vector<int>& layer_sizes, double density,
+                            std::mt19937* generator);
+}
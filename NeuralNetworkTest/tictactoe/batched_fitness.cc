@@ -0,0 +1,12 @@
+
+#include "tictactoe/batched_fitness.h"
+#include "tictactoe/network_policy.h"
+
+namespace TicTacToe {
+
+double SimpleNetworkBatchedFitness::operator()() const {
+  thread_local NetworkPolicy policy;
+  policy.Compute(*network_);
+  return SlowPolicyScore(policy);
+}
+}
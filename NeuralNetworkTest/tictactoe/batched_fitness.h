@@ -0,0 +1,22 @@
+#pragma once
+
+#include "nn/simple_network.h"
+
+namespace TicTacToe {
+
+// Computes the same score as SimpleNetworkSlowFitness, but on the shared
+// StateGraph instead of by recursion. The positions in which the network has
+// to move are collected turn by turn and each turn is run through the network
+// in one batch. The resulting policy is then scored in one bottom-up sweep
+// over the graph. The scratch memory is kept per thread and reused.
+struct SimpleNetworkBatchedFitness {
+ public:
+  SimpleNetworkBatchedFitness(const SimpleNetwork* network)
+      : network_(network) {}
+
+  double operator()() const;
+
+ private:
+  const SimpleNetwork* network_;
+};
+}
@@ -0,0 +1,29 @@
+
+#include <random>
+
+#include "nn/simple_network_testing.h"
+#include "tictactoe/batched_fitness.h"
+#include "tictactoe/simple_network_support.h"
+#include "gtest/gtest.h"
+
+using simple_network_testing::RandomNetwork;
+
+TEST(BatchedFitnessTest, TestNetworkTest) {
+  SimpleNetwork network(std::vector<int>{10, 9});
+  network.AddConnection(SimpleNetwork::Edge(0, 9, 4), 1.0);
+  network.AddConnection(SimpleNetwork::Edge(0, 4, 0), -0.5);
+  network.AddConnection(SimpleNetwork::Edge(0, 4, 8), 0.5);
+  EXPECT_DOUBLE_EQ(TicTacToe::SimpleNetworkBatchedFitness(&network)(), -104);
+}
+
+// The batched evaluation has to score exactly like the recursive one.
+TEST(BatchedFitnessTest, SlowFitnessTest) {
+  std::mt19937 generator(3);
+  const std::vector<std::vector<int>> shapes{{10, 9}, {10, 6, 9}};
+  for (int i = 0; i < 20; ++i) {
+    const SimpleNetwork network =
+        RandomNetwork(shapes[i % 2], 0.5, &generator);
+    EXPECT_EQ(TicTacToe::SimpleNetworkBatchedFitness(&network)(),
+              TicTacToe::SimpleNetworkSlowFitness(&network)());
+  }
+}
@@ -1,20 +1,52 @@
 
+#include <fstream>
 #include <iostream>
+#include <string>
 
 #include "evolution/process.h"
 #include "nn/simple_network.h"
 #include "nn/simple_network_evolver.h"
+#include "nn/simple_network_io.h"
 #include "tictactoe/interactive.h"
+#include "tictactoe/network_policy.h"
+#include "tictactoe/policy_cache.h"
 #include "tictactoe/simple_network_support.h"
+#include "util/concurrency/thread_pool.h"
 
 using SNProcess = Process<SimpleNetwork>;
 
+// The networks use the default activation function, which gets this id in
+// saved files.
+const simple_network_io::ActivationId kIdentityActivation = 0;
+
+// Other ids are rejected, so files with other activation functions fail to
+// load.
+simple_network_io::ActivationFunction ResolveActivation(
+    simple_network_io::ActivationId activation) {
+  if (activation == kIdentityActivation) {
+    return [](double x) { return x; };
+  }
+  return nullptr;
+}
+
 double Fitness1(const SimpleNetwork& network) {
   return TicTacToe::SimpleNetworkFastFitness(&network)();
 }
 
+// Fitness2 only depends on the moves of a network, and many networks of a
+// generation play alike, so its scores are cached by policy.
+double Fitness2Score(const TicTacToe::NetworkPolicy& policy) {
+  return TicTacToe::SlowPolicyScore(policy) +
+         TicTacToe::FastPolicyScore(policy,
+                                    TicTacToe::OpponentTable::Scripted()) *
+             25;
+}
+
 double Fitness2(const SimpleNetwork& network) {
-  return TicTacToe::SimpleNetworkSlowFitness(&network)() + Fitness1(network) * 25;
+  static const TicTacToe::SimpleNetworkPolicyFitness::PolicyScore score =
+      &Fitness2Score;
+  static TicTacToe::PolicyCache cache;
+  return TicTacToe::SimpleNetworkPolicyFitness(&network, &score, &cache)();
 }
 
 void PrintNetworkWeights(const SimpleNetwork& network) {
@@ -56,6 +88,9 @@ SNProcess::Options ConstructFirstOptions() {
   evolution_options.evolution_terminate =
       SNProcess::TerminateAfterNGenerations(6, each_generation);
   evolution_options.offspring_count = 40;
+  // The games of some networks last much longer than others, so the
+  // specimens are scored by work stealing.
+  evolution_options.thread_pool = util::concurrency::ThreadPool::Default();
   return evolution_options;
 }
 
@@ -72,20 +107,44 @@ SNProcess::Options ConstructSecondOptions() {
   evolution_options.evolution_terminate =
       SNProcess::TerminateAfterNGenerations(4, each_generation);
   evolution_options.offspring_count = 30;
+  evolution_options.thread_pool = util::concurrency::ThreadPool::Default();
   return evolution_options;
 }
 
+// Usage: experiment [champion file]
+// If the file exists, the network in it is played against instead of evolving
+// a new one. Otherwise the evolved network is saved to it.
 int main(int argc, char** argv) {
-  SimpleNetworkEvolver evolver = ConstructEvolver();
-  SNProcess::Options first_options = ConstructFirstOptions();
-  SNProcess::Generation generation =
-      SNProcess::Evolution(&evolver, &Fitness1, first_options);
+  const std::string champion_path = (argc > 1 ? argv[1] : "");
+  std::vector<SimpleNetwork> champions;
+  if (!champion_path.empty() && std::ifstream(champion_path).good()) {
+    // Do not overwrite a file that exists but cannot be read.
+    if (!simple_network_io::LoadNetworks(champion_path, &ResolveActivation,
+                                         &champions) ||
+        champions.empty()) {
+      std::cerr << "Could not read a network from " << champion_path
+                << std::endl;
+      return 1;
+    }
+  } else {
+    SimpleNetworkEvolver evolver = ConstructEvolver();
+    SNProcess::Options first_options = ConstructFirstOptions();
+    SNProcess::Generation generation =
+        SNProcess::Evolution(&evolver, &Fitness1, first_options);
 
-  SNProcess::Options second_options = ConstructSecondOptions();
-  second_options.starting_generation = generation;
-  generation = SNProcess::Evolution(&evolver, &Fitness2, second_options);
-  PrintNetworkWeights(generation[0]);
+    SNProcess::Options second_options = ConstructSecondOptions();
+    second_options.starting_generation = generation;
+    generation = SNProcess::Evolution(&evolver, &Fitness2, second_options);
+    champions.assign(1, generation[0]);
+    if (!champion_path.empty() &&
+        !simple_network_io::SaveNetworks(champion_path, {&champions[0]},
+                                         kIdentityActivation)) {
+      std::cerr << "Could not save the network to " << champion_path
+                << std::endl;
+    }
+  }
+  PrintNetworkWeights(champions[0]);
 
-  for (;;) TicTacToe::PlayAgainstAI(generation[0]);
+  for (;;) TicTacToe::PlayAgainstAI(champions[0]);
   return 0;
 }
@@ -1,11 +1,97 @@
 
-#include <unordered_set>
+#include <algorithm>
 #include <vector>
 
 #include "tictactoe/game.h"
 
 namespace TicTacToe {
 
+namespace {
+// Whether a tile mask contains a winning combination, for all 512 masks.
+std::array<bool, 512> ComputeWinningTable() {
+  std::array<bool, 512> result{};
+  for (unsigned int mask = 0; mask < result.size(); ++mask) {
+    for (const Game::TileMask winning_mask : Game::WinningMasks) {
+      if ((mask & winning_mask) == winning_mask) {
+        result[mask] = true;
+      }
+    }
+  }
+  return result;
+}
+
+// The sum of 3^i over all bits i of a tile mask, for all 512 masks. The ID of a
+// game is then the X value plus twice the O value.
+std::array<unsigned int, 512> ComputeTernaryTable() {
+  std::array<unsigned int, 512> result{};
+  for (unsigned int mask = 0; mask < result.size(); ++mask) {
+    unsigned int factor = 1;
+    for (int bit = 0; bit < 9; ++bit) {
+      if (mask & (1 << bit)) {
+        result[mask] += factor;
+      }
+      factor *= 3;
+    }
+  }
+  return result;
+}
+
+// Where the tile (x, y) ends up under each symmetry of the board.
+Game::Position SymmetricPosition(int symmetry, int x, int y) {
+  switch (symmetry) {
+    case 1:
+      return Game::Position(2 - y, x);
+    case 2:
+      return Game::Position(2 - x, 2 - y);
+    case 3:
+      return Game::Position(y, 2 - x);
+    case 4:
+      return Game::Position(2 - x, y);
+    case 5:
+      return Game::Position(x, 2 - y);
+    case 6:
+      return Game::Position(y, x);
+    case 7:
+      return Game::Position(2 - y, 2 - x);
+    default:
+      return Game::Position(x, y);
+  }
+}
+
+using SymmetryTable =
+    std::array<std::array<Game::TileMask, 512>, Game::kSymmetryCount>;
+
+// The image of every tile mask under every symmetry.
+SymmetryTable ComputeSymmetryTable() {
+  SymmetryTable result{};
+  for (int symmetry = 0; symmetry < Game::kSymmetryCount; ++symmetry) {
+    for (unsigned int mask = 0; mask < 512; ++mask) {
+      for (const Game::Position& tile : Game::TileRange(mask)) {
+        const Game::Position image =
+            SymmetricPosition(symmetry, tile.first, tile.second);
+        result[symmetry][mask] |= Game::TileBit(image.first, image.second);
+      }
+    }
+  }
+  return result;
+}
+
+const std::array<bool, 512>& WinningTable() {
+  static const std::array<bool, 512> table = ComputeWinningTable();
+  return table;
+}
+
+const std::array<unsigned int, 512>& TernaryTable() {
+  static const std::array<unsigned int, 512> table = ComputeTernaryTable();
+  return table;
+}
+
+const SymmetryTable& Symmetries() {
+  static const SymmetryTable table = ComputeSymmetryTable();
+  return table;
+}
+}
+
 const std::array<std::array<Game::Position, 3>, 8> Game::WinningCombinations = {
     std::array<Position, 3>{Position{0, 0}, Position{1, 1}, Position{2, 2}},
     std::array<Position, 3>{Position{2, 0}, Position{1, 1}, Position{0, 2}},
@@ -16,9 +102,26 @@ const std::array<std::array<Game::Position, 3>, 8> Game::WinningCombinations = {
     std::array<Position, 3>{Position{0, 1}, Position{1, 1}, Position{2, 1}},
     std::array<Position, 3>{Position{0, 2}, Position{1, 2}, Position{2, 2}}};
 
-Player Game::Tile(int x, int y) const { return board_[x][y]; }
+// Written out rather than derived from WinningCombinations, so that the tables
+// above do not depend on the initialization order of the two arrays.
+const std::array<Game::TileMask, 8> Game::WinningMasks = {
+    0x111, 0x054, 0x007, 0x038, 0x1c0, 0x049, 0x092, 0x124};
+
+const Game::TileMask Game::kFullBoard;
+const unsigned int Game::kIDCount;
+const int Game::kSymmetryCount;
+
+Player Game::Tile(int x, int y) const {
+  const TileMask bit = TileBit(x, y);
+  return static_cast<Player>(((x_tiles_ & bit) ? X : None) |
+                             ((o_tiles_ & bit) ? O : None));
+}
 
-void Game::SetTile(int x, int y, Player player) { board_[x][y] = player; }
+void Game::SetTile(int x, int y, Player player) {
+  const TileMask bit = TileBit(x, y);
+  x_tiles_ = (player & X) ? (x_tiles_ | bit) : (x_tiles_ & ~bit);
+  o_tiles_ = (player & O) ? (o_tiles_ | bit) : (o_tiles_ & ~bit);
+}
 
 Player Game::Tile(const Position& xy) const {
   return Tile(xy.first, xy.second);
@@ -28,65 +131,66 @@ void Game::SetTile(const Position& xy, Player player) {
   SetTile(xy.first, xy.second, player);
 }
 
-Player Game::Winner() const {
-  // Collect all players which met at least one winning condition.
-  std::unordered_set<Player> winners;
-  for (const std::array<Position, 3>& winning_combination :
-       WinningCombinations) {
-    const Position a = winning_combination[0], b = winning_combination[1],
-                   c = winning_combination[2];
-    if (Tile(a) == Tile(b) && Tile(b) == Tile(c)) {
-      winners.insert(Tile(a));
-    }
-  }
-
-  // Return the actual winner.
-  if (winners.find(None) != winners.end()) {
-    winners.erase(winners.find(None));
-  }
-  if (winners.empty()) {
-    return None;
-  } else if (winners.size() == 1) {
-    return *winners.begin();
-  } else {
-    return Both;
+Game::TileMask Game::Tiles(Player player) const {
+  switch (player) {
+    case X:
+      return x_tiles_;
+    case O:
+      return o_tiles_;
+    case Both:
+      return x_tiles_ & o_tiles_;
+    default:
+      return kFullBoard & ~(x_tiles_ | o_tiles_);
   }
 }
 
-int Game::Turns() const {
-  int result = 0;
-  for (int x = 0; x < 3; ++x) {
-    for (int y = 0; y < 3; ++y) {
-      if (Tile(x, y) != None) {
-        result++;
-      }
-    }
-  }
-  return result;
+Player Game::Winner() const {
+  const std::array<bool, 512>& winning = WinningTable();
+  return static_cast<Player>((winning[x_tiles_] ? X : None) |
+                             (winning[o_tiles_] ? O : None));
 }
 
 std::vector<Game::Position> Game::FreeMoves() const {
-  std::vector<Position> result;
-  for (int x = 0; x < 3; ++x) {
-    for (int y = 0; y < 3; ++y) {
-      if (Tile(x, y) == None) {
-        result.emplace_back(x, y);
-      }
-    }
+  const TileRange free_moves = FreeMoveRange();
+  return std::vector<Position>(free_moves.begin(), free_moves.end());
+}
+
+bool Game::Over() const {
+  return (x_tiles_ | o_tiles_) == kFullBoard || Winner() != None;
+}
+
+unsigned int Game::ID() const {
+  const std::array<unsigned int, 512>& ternary = TernaryTable();
+  return ternary[x_tiles_] + 2 * ternary[o_tiles_];
+}
+
+Game Game::FromID(unsigned int id) {
+  Game result;
+  for (int index = 0; index < 9; ++index) {
+    const unsigned int digit = id % 3;
+    result.x_tiles_ |= (digit == X ? 1 : 0) << index;
+    result.o_tiles_ |= (digit == O ? 1 : 0) << index;
+    id /= 3;
   }
   return result;
 }
 
-bool Game::Over() const { return Winner() != None || Turns() == 9; }
+Game Game::Symmetric(int symmetry) const {
+  const std::array<TileMask, 512>& image = Symmetries()[symmetry];
+  Game result;
+  result.x_tiles_ = image[x_tiles_];
+  result.o_tiles_ = image[o_tiles_];
+  return result;
+}
 
-unsigned int Game::ID() const {
-  unsigned int result = 0;
-  unsigned int factor = 1;
-  for (int x = 0; x < 3; ++x) {
-    for (int y = 0; y < 3; ++y) {
-      result += static_cast<int>(Tile(x, y)) * factor;
-      factor *= 3;
-    }
+unsigned int Game::CanonicalID() const {
+  const std::array<unsigned int, 512>& ternary = TernaryTable();
+  const SymmetryTable& symmetries = Symmetries();
+  unsigned int result = ID();
+  for (int symmetry = 1; symmetry < kSymmetryCount; ++symmetry) {
+    const std::array<TileMask, 512>& image = symmetries[symmetry];
+    result = std::min(result, ternary[image[x_tiles_]] +
+                                  2 * ternary[image[o_tiles_]]);
   }
   return result;
 }
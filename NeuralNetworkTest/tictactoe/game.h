@@ -1,36 +1,102 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <vector>
 
 namespace TicTacToe {
 
 enum Player { None = 0, X = 1, O = 2, Both = 3 };
 
+// The board is stored as one bitmask of tiles per player, so that win checks,
+// turn counting and move generation are a few bit operations each.
 class Game {
  public:
   using Position = std::pair<int, int>;
 
+  // A set of tiles. Bit 3 * x + y stands for the tile (x, y), which is also
+  // the order in which ID() weighs the tiles.
+  using TileMask = uint16_t;
+  static const TileMask kFullBoard = 0x1ff;
+
+  // The number of different values ID() can return.
+  static const unsigned int kIDCount = 19683;
+  // The number of symmetries of the board (rotations and reflections).
+  static const int kSymmetryCount = 8;
+
+  // Iterates over the positions of the tiles in a mask in order of their bits.
+  class TileRange {
+   public:
+    class Iterator {
+     public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = Position;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const Position*;
+      using reference = Position;
+
+      explicit Iterator(TileMask mask) : mask_(mask) {}
+      Position operator*() const { return TilePosition(__builtin_ctz(mask_)); }
+      Iterator& operator++() {
+        mask_ &= mask_ - 1;
+        return *this;
+      }
+      bool operator==(const Iterator& other) const {
+        return mask_ == other.mask_;
+      }
+      bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+     private:
+      TileMask mask_;
+    };
+
+    explicit TileRange(TileMask mask) : mask_(mask) {}
+    Iterator begin() const { return Iterator(mask_); }
+    Iterator end() const { return Iterator(0); }
+    int size() const { return __builtin_popcount(mask_); }
+    bool empty() const { return mask_ == 0; }
+    Position front() const { return *begin(); }
+
+   private:
+    TileMask mask_;
+  };
+
   Game() = default;
 
+  // Conversions between positions and their bits in a TileMask.
+  static int TileIndex(int x, int y) { return 3 * x + y; }
+  static TileMask TileBit(int x, int y) { return 1 << TileIndex(x, y); }
+  static Position TilePosition(int index) {
+    return Position(index / 3, index % 3);
+  }
+
   // Getter and setter for single tiles.
   Player Tile(int x, int y) const;
   void SetTile(int x, int y, Player player);
   Player Tile(const Position& xy) const;
   void SetTile(const Position& xy, Player player);
 
+  // The tiles taken by a player. For None, these are the free tiles.
+  TileMask Tiles(Player player) const;
+
   // List of all winning combinations.
   static const std::array<std::array<Position, 3>, 8> WinningCombinations;
+  // The same combinations as tile masks.
+  static const std::array<TileMask, 8> WinningMasks;
 
   // Return the winner (if there is one).
   Player Winner() const;
 
   // Returns the number of turns that has passed (i.e. the number of tiles that
   // are not free).
-  int Turns() const;
+  int Turns() const { return __builtin_popcount(x_tiles_ | o_tiles_); }
 
   // Return a list of all possible moves (i.e. the tiles that are free).
   std::vector<Position> FreeMoves() const;
+  // The same moves without allocating.
+  TileRange FreeMoveRange() const { return TileRange(Tiles(None)); }
 
   // Returns whether the game is over; this is achieved by filling the board or
   // by reaching a winner.
@@ -38,12 +104,20 @@ class Game {
 
   // Computes a number which uniquely identifies this game state.
   unsigned int ID() const;
+  // The game with the given ID, which must be less than kIDCount.
+  static Game FromID(unsigned int id);
+
+  // Returns this game rotated or mirrored by one of the symmetries of the
+  // board. Symmetry 0 is the identity.
+  Game Symmetric(int symmetry) const;
+
+  // The smallest ID of all symmetric versions of this game. Games which are
+  // rotations or reflections of each other share it.
+  unsigned int CanonicalID() const;
 
  private:
-  std::array<std::array<Player, 3>, 3> board_{
-      {std::array<Player, 3>{None, None, None},
-       std::array<Player, 3>{None, None, None},
-       std::array<Player, 3>{None, None, None}}};
+  TileMask x_tiles_ = 0;
+  TileMask o_tiles_ = 0;
 };
 }
 
@@ -0,0 +1,108 @@
+
+#include <algorithm>
+
+#include "tictactoe/game.h"
+#include "gtest/gtest.h"
+
+namespace {
+// Fills a board from the digits of a number in base 3, in the order of ID().
+TicTacToe::Game GameFromNumber(unsigned int number) {
+  TicTacToe::Game game;
+  for (int x = 0; x < 3; ++x) {
+    for (int y = 0; y < 3; ++y) {
+      game.SetTile(x, y, static_cast<TicTacToe::Player>(number % 3));
+      number /= 3;
+    }
+  }
+  return game;
+}
+
+// Finds the winner by checking the winning combinations one tile at a time.
+TicTacToe::Player ReferenceWinner(const TicTacToe::Game& game) {
+  int winner = TicTacToe::None;
+  for (const auto& combination : TicTacToe::Game::WinningCombinations) {
+    const TicTacToe::Player tile = game.Tile(combination[0]);
+    if (tile == game.Tile(combination[1]) &&
+        tile == game.Tile(combination[2])) {
+      winner |= tile;
+    }
+  }
+  return static_cast<TicTacToe::Player>(winner);
+}
+}
+
+// Checks every board against the straightforward definitions.
+TEST(GameTest, AllBoardsTest) {
+  for (unsigned int number = 0; number < 19683; ++number) {
+    const TicTacToe::Game game = GameFromNumber(number);
+    EXPECT_EQ(game.ID(), number);
+    EXPECT_EQ(TicTacToe::Game::FromID(number).Tiles(TicTacToe::X),
+              game.Tiles(TicTacToe::X));
+    EXPECT_EQ(TicTacToe::Game::FromID(number).Tiles(TicTacToe::O),
+              game.Tiles(TicTacToe::O));
+
+    std::vector<TicTacToe::Game::Position> free_moves;
+    for (int x = 0; x < 3; ++x) {
+      for (int y = 0; y < 3; ++y) {
+        if (game.Tile(x, y) == TicTacToe::None) {
+          free_moves.emplace_back(x, y);
+        }
+      }
+    }
+    EXPECT_EQ(game.FreeMoves(), free_moves);
+    EXPECT_EQ(game.FreeMoveRange().size(), free_moves.size());
+    EXPECT_EQ(game.Turns(), 9 - static_cast<int>(free_moves.size()));
+
+    const TicTacToe::Player winner = ReferenceWinner(game);
+    EXPECT_EQ(game.Winner(), winner);
+    EXPECT_EQ(game.Over(), winner != TicTacToe::None || free_moves.empty());
+  }
+}
+
+TEST(GameTest, SetTileTest) {
+  TicTacToe::Game game;
+  game.SetTile(2, 1, TicTacToe::X);
+  game.SetTile(0, 2, TicTacToe::O);
+  EXPECT_EQ(game.Tile(2, 1), TicTacToe::X);
+  EXPECT_EQ(game.Tile(0, 2), TicTacToe::O);
+  EXPECT_EQ(game.Tiles(TicTacToe::X), TicTacToe::Game::TileBit(2, 1));
+  EXPECT_EQ(game.Tiles(TicTacToe::O), TicTacToe::Game::TileBit(0, 2));
+
+  // Overwriting and clearing a tile.
+  game.SetTile(2, 1, TicTacToe::O);
+  EXPECT_EQ(game.Tile(2, 1), TicTacToe::O);
+  EXPECT_EQ(game.Tiles(TicTacToe::X), 0);
+  game.SetTile(2, 1, TicTacToe::None);
+  EXPECT_EQ(game.Tile(2, 1), TicTacToe::None);
+  EXPECT_EQ(game.Turns(), 1);
+}
+
+TEST(GameTest, SymmetryTest) {
+  TicTacToe::Game game;
+  game.SetTile(0, 0, TicTacToe::X);
+  game.SetTile(1, 0, TicTacToe::O);
+  game.SetTile(2, 2, TicTacToe::X);
+
+  // All symmetries are different for this game and lead to the same canonical
+  // ID, which is the smallest of their IDs.
+  std::vector<unsigned int> ids;
+  for (int symmetry = 0; symmetry < TicTacToe::Game::kSymmetryCount;
+       ++symmetry) {
+    const TicTacToe::Game image = game.Symmetric(symmetry);
+    EXPECT_EQ(image.Turns(), 3);
+    EXPECT_EQ(image.Tile(1, 1), TicTacToe::None);
+    EXPECT_EQ(image.CanonicalID(), game.CanonicalID());
+    ids.push_back(image.ID());
+  }
+  EXPECT_EQ(ids[0], game.ID());
+  EXPECT_EQ(*std::min_element(ids.begin(), ids.end()), game.CanonicalID());
+  std::sort(ids.begin(), ids.end());
+  EXPECT_EQ(std::unique(ids.begin(), ids.end()), ids.end());
+
+  // Symmetries keep the winner.
+  game.SetTile(1, 1, TicTacToe::X);
+  for (int symmetry = 0; symmetry < TicTacToe::Game::kSymmetryCount;
+       ++symmetry) {
+    EXPECT_EQ(game.Symmetric(symmetry).Winner(), TicTacToe::X);
+  }
+}
@@ -0,0 +1,169 @@
+
+#include <algorithm>
+#include <vector>
+
+#include "snowhouse/snowhouse.h"
+#include "tictactoe/network_policy.h"
+#include "tictactoe/simple_network_support.h"
+
+namespace TicTacToe {
+
+namespace {
+using NodeIndex = StateGraph::NodeIndex;
+
+// Mixes a value into one half of a fingerprint.
+uint64_t HashCombine(uint64_t hash, uint64_t value, uint64_t multiplier) {
+  uint64_t mixed = (hash ^ value) * multiplier;
+  mixed ^= mixed >> 32;
+  return mixed;
+}
+
+// The score of a node reached after some move: the final score if the board
+// is full and the score of X's next move otherwise.
+double ScoreAfterMove(const StateGraph& graph,
+                      const std::vector<double>& scores, NodeIndex index) {
+  const StateGraph::Node& node = graph.node(index);
+  return (node.turns == 9 ? node.final_score : scores[index]);
+}
+
+// The score of a game of SimpleNetworkFastFitness, starting with X's move.
+double FastScoreFrom(const StateGraph& graph, const NetworkPolicy& policy,
+                     const OpponentTable& opponent, NodeIndex index) {
+  for (;;) {
+    if (graph.node(index).game.Over()) {
+      return graph.node(index).final_score;
+    }
+    index = graph.Successor(index, opponent.Move(graph.node(index).game), X);
+    if (graph.node(index).game.Over()) {
+      return graph.node(index).final_score;
+    }
+    index = policy.OSuccessor(index);
+  }
+}
+}
+
+void NetworkPolicy::Compute(const SimpleNetwork& network) {
+  try {
+    AssertThat(network.LayerSize(0), snowhouse::Equals(10u));
+    AssertThat(network.LayerSize(network.LayerNumber() - 1),
+               snowhouse::Equals(9u));
+  } catch (const snowhouse::AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  network.Compile();
+
+  const StateGraph& graph = StateGraph::Instance();
+  x_to_move_.assign(graph.size(), 0);
+  o_to_move_.assign(graph.size(), 0);
+  o_successor_.resize(graph.size());
+  fingerprint_ = PolicyFingerprint();
+
+  // Either X starts on the empty board or the network does.
+  const NodeIndex start = graph.Find(Game());
+  x_to_move_[start] = 1;
+  o_to_move_[start] = 1;
+
+  // Find all nodes that can be reached with the network's policy, one turn at
+  // a time. Nodes with a full board end the game and need no move.
+  for (int turns = 0; turns < 9; ++turns) {
+    const NodeIndex begin = graph.TurnsBegin(turns);
+    const NodeIndex end = graph.TurnsEnd(turns);
+
+    // Let the network move on all nodes of this turn in one batch.
+    batch_.clear();
+    for (NodeIndex i = begin; i < end; ++i) {
+      if (o_to_move_[i]) {
+        batch_.push_back(i);
+      }
+    }
+    const unsigned int batch_size = batch_.size();
+    if (batch_size > 0) {
+      if (inputs_.size() < batch_size * 10) {
+        inputs_.resize(batch_size * 10);
+        outputs_.resize(batch_size * 9);
+      }
+      for (unsigned int b = 0; b < batch_size; ++b) {
+        GameToNetworkInput(graph.node(batch_[b]).game,
+                           inputs_.data() + b * 10);
+      }
+      workspace_.Reserve(network, batch_size);
+      network.ForwardBatch(inputs_.data(), batch_size, outputs_.data(),
+                           &workspace_);
+      for (unsigned int b = 0; b < batch_size; ++b) {
+        const NodeIndex index = batch_[b];
+        const Game::Position move =
+            SelectMove(graph.node(index).game, outputs_.data() + b * 9);
+        const NodeIndex successor = graph.Successor(index, move, O);
+        o_successor_[index] = successor;
+        if (graph.node(successor).turns < 9) {
+          x_to_move_[successor] = 1;
+        }
+
+        // The nodes are visited in a fixed order, so hashing the moves in
+        // that order identifies the policy.
+        const uint64_t entry = (uint64_t{index} << 4) |
+                               Game::TileIndex(move.first, move.second);
+        fingerprint_.low =
+            HashCombine(fingerprint_.low, entry, 0x9e3779b97f4a7c15ull);
+        fingerprint_.high =
+            HashCombine(fingerprint_.high, entry, 0xbf58476d1ce4e5b9ull);
+      }
+    }
+
+    // Let X try every move.
+    for (NodeIndex i = begin; i < end; ++i) {
+      if (!x_to_move_[i]) {
+        continue;
+      }
+      for (const NodeIndex* successor = graph.XSuccessorsBegin(i);
+           successor != graph.XSuccessorsEnd(i); ++successor) {
+        if (graph.node(*successor).turns < 9) {
+          o_to_move_[*successor] = 1;
+        }
+      }
+    }
+  }
+}
+
+double SlowPolicyScore(const NetworkPolicy& policy) {
+  const StateGraph& graph = StateGraph::Instance();
+  thread_local std::vector<double> scores;
+  scores.resize(graph.size());
+
+  // Score the nodes on which X moves, starting with the latest turn. The
+  // score of a node is the sum over all moves of X.
+  for (int turns = 8; turns >= 0; --turns) {
+    for (NodeIndex i = graph.TurnsBegin(turns); i < graph.TurnsEnd(turns);
+         ++i) {
+      if (!policy.XToMove(i)) {
+        continue;
+      }
+      double score = 0.0;
+      for (const NodeIndex* successor = graph.XSuccessorsBegin(i);
+           successor != graph.XSuccessorsEnd(i); ++successor) {
+        if (graph.node(*successor).turns == 9) {
+          score += graph.node(*successor).final_score;
+        } else {
+          score += ScoreAfterMove(graph, scores, policy.OSuccessor(*successor));
+        }
+      }
+      scores[i] = score;
+    }
+  }
+
+  const NodeIndex start = graph.Find(Game());
+  return scores[start] +
+         ScoreAfterMove(graph, scores, policy.OSuccessor(start));
+}
+
+double FastPolicyScore(const NetworkPolicy& policy,
+                       const OpponentTable& opponent) {
+  const StateGraph& graph = StateGraph::Instance();
+  const NodeIndex start = graph.Find(Game());
+  return FastScoreFrom(graph, policy, opponent, start) +
+         FastScoreFrom(graph, policy, opponent, policy.OSuccessor(start));
+}
+}
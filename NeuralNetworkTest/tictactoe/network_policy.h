@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "nn/simple_network.h"
+#include "tictactoe/opponent_table.h"
+#include "tictactoe/state_graph.h"
+
+namespace TicTacToe {
+
+// Identifies a policy, see NetworkPolicy::fingerprint().
+struct PolicyFingerprint {
+  uint64_t low = 0;
+  uint64_t high = 0;
+
+  bool operator==(const PolicyFingerprint& other) const {
+    return low == other.low && high == other.high;
+  }
+  bool operator!=(const PolicyFingerprint& other) const {
+    return !(*this == other);
+  }
+};
+
+// The moves a network makes as O on all nodes of the StateGraph that
+// SimpleNetworkSlowFitness can reach with it: X either starts or moves second
+// and tries every move, O always follows the network. The nodes of each turn
+// are run through the network in one batch.
+//
+// The fitness functions only depend on these moves, so networks with the same
+// policy get the same scores. The fingerprint makes such networks easy to
+// recognize. An object can be reused for many networks without allocating.
+class NetworkPolicy {
+ public:
+  using NodeIndex = StateGraph::NodeIndex;
+
+  NetworkPolicy() = default;
+
+  // Computes the policy of a network with 10 inputs and 9 outputs.
+  void Compute(const SimpleNetwork& network);
+
+  // Whether X moves on a node, i.e. the node is reachable and it is X's turn.
+  bool XToMove(NodeIndex index) const { return x_to_move_[index]; }
+  // Whether O moves on a node.
+  bool OToMove(NodeIndex index) const { return o_to_move_[index]; }
+  // The node after O's move, for nodes on which O moves.
+  NodeIndex OSuccessor(NodeIndex index) const { return o_successor_[index]; }
+
+  // A 128 bit hash of the moves on all nodes on which O moves. Equal policies
+  // have equal fingerprints; different ones almost certainly do not.
+  const PolicyFingerprint& fingerprint() const { return fingerprint_; }
+
+ private:
+  std::vector<uint8_t> x_to_move_;
+  std::vector<uint8_t> o_to_move_;
+  std::vector<NodeIndex> o_successor_;
+  PolicyFingerprint fingerprint_;
+
+  // The nodes of the current batch and their network inputs and outputs.
+  std::vector<NodeIndex> batch_;
+  std::vector<double> inputs_;
+  std::vector<double> outputs_;
+  SimpleNetwork::Workspace workspace_;
+};
+
+// The score of SimpleNetworkSlowFitness for the network of a policy.
+double SlowPolicyScore(const NetworkPolicy& policy);
+
+// The score of SimpleNetworkFastFitness for the network of a policy. The
+// opponent must only use moves that are nodes of the StateGraph, which holds
+// for every policy that plays X and takes free tiles.
+double FastPolicyScore(const NetworkPolicy& policy,
+                       const OpponentTable& opponent);
+}
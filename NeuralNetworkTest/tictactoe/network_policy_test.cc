@@ -0,0 +1,55 @@
+
+#include <random>
+
+#include "nn/simple_network_testing.h"
+#include "tictactoe/network_policy.h"
+#include "tictactoe/simple_network_support.h"
+#include "gtest/gtest.h"
+
+using simple_network_testing::RandomNetwork;
+
+// The scores of a policy have to equal the fitness functions of its network.
+TEST(NetworkPolicyTest, ScoreTest) {
+  std::mt19937 generator(5);
+  const std::vector<std::vector<int>> shapes{{10, 9}, {10, 6, 9}};
+  const TicTacToe::OpponentTable random_opponent(
+      TicTacToe::SeededRandomPolicy(1));
+  TicTacToe::NetworkPolicy policy;
+  for (int i = 0; i < 20; ++i) {
+    const SimpleNetwork network =
+        RandomNetwork(shapes[i % 2], 0.5, &generator);
+    policy.Compute(network);
+    EXPECT_EQ(TicTacToe::SlowPolicyScore(policy),
+              TicTacToe::SimpleNetworkSlowFitness(&network)());
+    EXPECT_EQ(TicTacToe::FastPolicyScore(
+                  policy, TicTacToe::OpponentTable::Scripted()),
+              TicTacToe::SimpleNetworkFastFitness(&network)());
+    const TicTacToe::SimpleNetworkFastFitness random_fitness(&network,
+                                                             &random_opponent);
+    EXPECT_EQ(TicTacToe::FastPolicyScore(policy, random_opponent),
+              random_fitness());
+  }
+}
+
+TEST(NetworkPolicyTest, FingerprintTest) {
+  std::mt19937 generator(9);
+  SimpleNetwork network = RandomNetwork({10, 9}, 0.5, &generator);
+  TicTacToe::NetworkPolicy policy;
+  policy.Compute(network);
+  const TicTacToe::PolicyFingerprint fingerprint = policy.fingerprint();
+
+  // Doubling all weights keeps every move.
+  SimpleNetwork scaled = network;
+  for (const SimpleNetwork::Edge& edge : network.ExistingEdges()) {
+    scaled.AddConnection(edge, 2 * network.ConnectionWeight(edge));
+  }
+  policy.Compute(scaled);
+  EXPECT_EQ(policy.fingerprint(), fingerprint);
+
+  // Flipping them changes the moves.
+  for (const SimpleNetwork::Edge& edge : network.ExistingEdges()) {
+    scaled.AddConnection(edge, -network.ConnectionWeight(edge));
+  }
+  policy.Compute(scaled);
+  EXPECT_NE(policy.fingerprint(), fingerprint);
+}
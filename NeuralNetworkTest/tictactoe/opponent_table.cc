@@ -0,0 +1,85 @@
+
+#include <array>
+
+#include "tictactoe/opponent_table.h"
+
+namespace TicTacToe {
+
+OpponentTable::OpponentTable(const Policy& policy)
+    : moves_(Game::kIDCount, 0) {
+  for (unsigned int id = 0; id < Game::kIDCount; ++id) {
+    const Game game = Game::FromID(id);
+    if (!game.FreeMoveRange().empty()) {
+      const Game::Position move = policy(game);
+      moves_[id] = Game::TileIndex(move.first, move.second);
+    }
+  }
+}
+
+const OpponentTable& OpponentTable::Scripted() {
+  static const OpponentTable table(&ScriptedOpponentMove);
+  return table;
+}
+
+Game::Position ScriptedOpponentMove(const Game& game) {
+  // Win if possible.
+  for (const std::array<Game::Position, 3>& winning_combination :
+       Game::WinningCombinations) {
+    Game::Position a = winning_combination[0], b = winning_combination[1],
+                   c = winning_combination[2];
+    if (game.Tile(a) == X && game.Tile(b) == X && game.Tile(c) == None) {
+      return c;
+    }
+    if (game.Tile(a) == X && game.Tile(b) == None && game.Tile(c) == X) {
+      return b;
+    }
+    if (game.Tile(a) == None && game.Tile(b) == X && game.Tile(c) == X) {
+      return a;
+    }
+  }
+
+  // Stop a victory if possible.
+  for (const std::array<Game::Position, 3>& winning_combination :
+       Game::WinningCombinations) {
+    Game::Position a = winning_combination[0], b = winning_combination[1],
+                   c = winning_combination[2];
+    if (game.Tile(a) == O && game.Tile(b) == O && game.Tile(c) == None) {
+      return c;
+    }
+    if (game.Tile(a) == O && game.Tile(b) == None && game.Tile(c) == O) {
+      return b;
+    }
+    if (game.Tile(a) == None && game.Tile(b) == O && game.Tile(c) == O) {
+      return a;
+    }
+  }
+
+  // Set in the center if it is free.
+  if (game.Tile(1, 1) == None) {
+    return Game::Position(1, 1);
+  }
+
+  // Choose a the first free position. (random is not an option beause fitness
+  // needs to be deterministic)
+  return game.FreeMoveRange().front();
+}
+
+OpponentTable::Policy SeededRandomPolicy(uint64_t seed) {
+  return [seed](const Game& game) {
+    // Mix the seed and the game ID into a pseudo random number.
+    uint64_t value = (seed ^ game.ID()) * 0x9e3779b97f4a7c15ull;
+    value ^= value >> 29;
+    value *= 0xbf58476d1ce4e5b9ull;
+    value ^= value >> 32;
+
+    const Game::TileRange free_moves = game.FreeMoveRange();
+    int choice = static_cast<int>(value % free_moves.size());
+    for (const Game::Position& move : free_moves) {
+      if (choice-- == 0) {
+        return move;
+      }
+    }
+    return free_moves.front();
+  };
+}
+}
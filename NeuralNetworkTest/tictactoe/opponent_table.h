@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "tictactoe/game.h"
+
+namespace TicTacToe {
+
+// A deterministic opponent compiled into a table with one move per game ID,
+// so that looking up a move is a single array access.
+class OpponentTable {
+ public:
+  // Returns the move of an opponent on a game with at least one free tile.
+  using Policy = std::function<Game::Position(const Game&)>;
+
+  // Evaluates the policy on every game that has a free tile.
+  explicit OpponentTable(const Policy& policy);
+
+  // The move of the opponent. The game must have a free tile.
+  Game::Position Move(const Game& game) const {
+    return Game::TilePosition(moves_[game.ID()]);
+  }
+
+  // The predefined opponent of SimpleNetworkFastFitness, see
+  // ScriptedOpponentMove. The table is built on the first call.
+  static const OpponentTable& Scripted();
+
+ private:
+  // The tile index (see Game::TileIndex) of the move on each game.
+  std::vector<uint8_t> moves_;
+};
+
+// Plays as X: wins if possible, otherwise stops a victory of O if possible,
+// otherwise takes the center and otherwise the first free tile.
+Game::Position ScriptedOpponentMove(const Game& game);
+
+// Returns a policy which picks a pseudo random free tile. The choice only
+// depends on the seed and the game, so the policy is deterministic.
+OpponentTable::Policy SeededRandomPolicy(uint64_t seed);
+}
@@ -0,0 +1,42 @@
+
+#include "tictactoe/opponent_table.h"
+#include "gtest/gtest.h"
+
+TEST(OpponentTableTest, ScriptedTest) {
+  const TicTacToe::OpponentTable& table = TicTacToe::OpponentTable::Scripted();
+  for (unsigned int id = 0; id < TicTacToe::Game::kIDCount; ++id) {
+    const TicTacToe::Game game = TicTacToe::Game::FromID(id);
+    if (!game.FreeMoveRange().empty()) {
+      EXPECT_EQ(table.Move(game), TicTacToe::ScriptedOpponentMove(game));
+    }
+  }
+
+  // Winning comes before blocking.
+  TicTacToe::Game game;
+  game.SetTile(0, 0, TicTacToe::X);
+  game.SetTile(1, 0, TicTacToe::X);
+  game.SetTile(0, 1, TicTacToe::O);
+  game.SetTile(1, 1, TicTacToe::O);
+  EXPECT_EQ(table.Move(game), TicTacToe::Game::Position(2, 0));
+}
+
+TEST(OpponentTableTest, SeededRandomTest) {
+  const TicTacToe::OpponentTable table1(TicTacToe::SeededRandomPolicy(5));
+  const TicTacToe::OpponentTable table2(TicTacToe::SeededRandomPolicy(5));
+  const TicTacToe::OpponentTable table3(TicTacToe::SeededRandomPolicy(6));
+
+  // The moves are free and only depend on the seed.
+  int different_moves = 0;
+  for (unsigned int id = 0; id < TicTacToe::Game::kIDCount; ++id) {
+    const TicTacToe::Game game = TicTacToe::Game::FromID(id);
+    if (game.FreeMoveRange().empty()) {
+      continue;
+    }
+    EXPECT_EQ(game.Tile(table1.Move(game)), TicTacToe::None);
+    EXPECT_EQ(table1.Move(game), table2.Move(game));
+    if (table1.Move(game) != table3.Move(game)) {
+      ++different_moves;
+    }
+  }
+  EXPECT_GT(different_moves, 0);
+}
@@ -0,0 +1,85 @@
+
+#include "tictactoe/oracle.h"
+
+namespace TicTacToe {
+
+namespace {
+Player Opponent(Player player) { return (player == X ? O : X); }
+}
+
+const Oracle& Oracle::Instance() {
+  static const Oracle oracle;
+  return oracle;
+}
+
+Oracle::Oracle()
+    : values_(2 * Game::kIDCount, 0),
+      optimal_moves_(2 * Game::kIDCount, 0),
+      solved_(2 * Game::kIDCount, 0) {
+  for (unsigned int id = 0; id < Game::kIDCount; ++id) {
+    Solve(Game::FromID(id), X);
+    Solve(Game::FromID(id), O);
+  }
+}
+
+unsigned int Oracle::Index(const Game& game, Player to_move) {
+  return 2 * game.ID() + (to_move == X ? 0 : 1);
+}
+
+int Oracle::Value(const Game& game, Player to_move) const {
+  return values_[Index(game, to_move)];
+}
+
+Game::TileMask Oracle::OptimalMoves(const Game& game, Player to_move) const {
+  return optimal_moves_[Index(game, to_move)];
+}
+
+Game::Position Oracle::BestMove(const Game& game, Player to_move) const {
+  return Game::TileRange(OptimalMoves(game, to_move)).front();
+}
+
+int Oracle::Solve(const Game& game, Player to_move) {
+  const unsigned int index = Index(game, to_move);
+  if (solved_[index]) {
+    return values_[index];
+  }
+
+  int value = 0;
+  Game::TileMask optimal_moves = 0;
+  const Player winner = game.Winner();
+  if (winner == to_move) {
+    value = 10 - game.Turns();
+  } else if (winner == Opponent(to_move)) {
+    value = game.Turns() - 10;
+  } else if (!game.Over()) {
+    // The value of a move is the negated value for the opponent afterwards.
+    bool first = true;
+    for (const Game::Position& move : game.FreeMoveRange()) {
+      Game next = game;
+      next.SetTile(move, to_move);
+      const int move_value = -Solve(next, Opponent(to_move));
+      const Game::TileMask bit = Game::TileBit(move.first, move.second);
+      if (first || move_value > value) {
+        value = move_value;
+        optimal_moves = bit;
+        first = false;
+      } else if (move_value == value) {
+        optimal_moves |= bit;
+      }
+    }
+  }
+
+  values_[index] = value;
+  optimal_moves_[index] = optimal_moves;
+  solved_[index] = 1;
+  return value;
+}
+
+Game::Position PerfectMove(const Game& game) {
+  // Games that are already over have no optimal moves.
+  if (game.Over()) {
+    return game.FreeMoveRange().front();
+  }
+  return Oracle::Instance().BestMove(game, X);
+}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "tictactoe/game.h"
+
+namespace TicTacToe {
+
+// Knows the value of every game under perfect play. The values are computed
+// once by a negamax search over all boards, memoized in a dense table indexed
+// by the game ID. Games end as soon as a player wins.
+class Oracle {
+ public:
+  // The oracle, which is computed on the first call.
+  static const Oracle& Instance();
+
+  // The value for the player to move if both players play perfectly. As in
+  // the fitness functions, a win is worth 10 - turns at the end of the game, a
+  // loss turns - 10 and a draw 0. So perfect play wins as fast and loses as
+  // slowly as possible.
+  int Value(const Game& game, Player to_move) const;
+
+  // The free tiles on which the player to move keeps that value. Empty if the
+  // game is over.
+  Game::TileMask OptimalMoves(const Game& game, Player to_move) const;
+
+  // The first of the optimal moves. The game must not be over.
+  Game::Position BestMove(const Game& game, Player to_move) const;
+
+ private:
+  Oracle();
+
+  // Computes the value of a game by negamax and stores it in the tables.
+  int Solve(const Game& game, Player to_move);
+
+  // The index of a game and player in the tables.
+  static unsigned int Index(const Game& game, Player to_move);
+
+  std::vector<int8_t> values_;
+  std::vector<Game::TileMask> optimal_moves_;
+  std::vector<uint8_t> solved_;
+};
+
+// Plays as X with perfect play, see Oracle::BestMove. On games that are over,
+// the first free tile is taken. Can be compiled into an OpponentTable.
+Game::Position PerfectMove(const Game& game);
+}
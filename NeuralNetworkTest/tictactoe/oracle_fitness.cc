@@ -0,0 +1,78 @@
+
+#include <vector>
+
+#include "snowhouse/snowhouse.h"
+#include "tictactoe/oracle.h"
+#include "tictactoe/oracle_fitness.h"
+#include "tictactoe/simple_network_support.h"
+
+namespace TicTacToe {
+
+namespace {
+// All positions which are not over and in which O is to move, with either
+// player having started. They do not depend on the network, so they and their
+// network inputs are computed only once.
+struct Positions {
+  std::vector<Game> games;
+  std::vector<Game::TileMask> optimal_moves;
+  std::vector<double> inputs;
+};
+
+Positions ComputePositions() {
+  const Oracle& oracle = Oracle::Instance();
+  Positions result;
+  for (unsigned int id = 0; id < Game::kIDCount; ++id) {
+    const Game game = Game::FromID(id);
+    const int difference = __builtin_popcount(game.Tiles(X)) -
+                           __builtin_popcount(game.Tiles(O));
+    if ((difference == 0 || difference == 1) && !game.Over()) {
+      result.games.push_back(game);
+      result.optimal_moves.push_back(oracle.OptimalMoves(game, O));
+    }
+  }
+  result.inputs.resize(result.games.size() * 10);
+  for (unsigned int i = 0; i < result.games.size(); ++i) {
+    GameToNetworkInput(result.games[i], result.inputs.data() + i * 10);
+  }
+  return result;
+}
+
+const Positions& AllPositions() {
+  static const Positions positions = ComputePositions();
+  return positions;
+}
+}
+
+double SimpleNetworkOracleFitness::operator()() const {
+  try {
+    AssertThat(network_->LayerSize(0), snowhouse::Equals(10u));
+    AssertThat(network_->LayerSize(network_->LayerNumber() - 1),
+               snowhouse::Equals(9u));
+  } catch (const snowhouse::AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
+  }
+
+  network_->Compile();
+
+  const Positions& positions = AllPositions();
+  const unsigned int batch_size = positions.games.size();
+  thread_local std::vector<double> outputs;
+  thread_local SimpleNetwork::Workspace workspace;
+  outputs.resize(batch_size * 9);
+  workspace.Reserve(*network_, batch_size);
+  network_->ForwardBatch(positions.inputs.data(), batch_size, outputs.data(),
+                         &workspace);
+
+  unsigned int optimal = 0;
+  for (unsigned int i = 0; i < batch_size; ++i) {
+    const Game::Position move =
+        SelectMove(positions.games[i], outputs.data() + i * 9);
+    if (positions.optimal_moves[i] & Game::TileBit(move.first, move.second)) {
+      ++optimal;
+    }
+  }
+  return static_cast<double>(optimal) / batch_size;
+}
+}
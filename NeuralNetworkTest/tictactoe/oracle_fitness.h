@@ -0,0 +1,22 @@
+#pragma once
+
+#include "nn/simple_network.h"
+
+namespace TicTacToe {
+
+// Calculates a fitness score of this network by comparing its moves with
+// perfect play. The score is the fraction of all positions in which O is to
+// move where the network picks one of the optimal moves of the Oracle. No
+// games are simulated: all positions are run through the network in one
+// batch.
+struct SimpleNetworkOracleFitness {
+ public:
+  SimpleNetworkOracleFitness(const SimpleNetwork* network)
+      : network_(network) {}
+
+  double operator()() const;
+
+ private:
+  const SimpleNetwork* network_;
+};
+}
@@ -0,0 +1,37 @@
+
+#include <random>
+
+#include "nn/simple_network_testing.h"
+#include "tictactoe/oracle.h"
+#include "tictactoe/oracle_fitness.h"
+#include "tictactoe/simple_network_support.h"
+#include "gtest/gtest.h"
+
+// The batched score has to match playing each position with AINextMove.
+TEST(OracleFitnessTest, AINextMoveTest) {
+  std::mt19937 generator(17);
+  const SimpleNetwork network =
+      simple_network_testing::RandomNetwork({10, 6, 9}, 0.5, &generator);
+
+  const TicTacToe::Oracle& oracle = TicTacToe::Oracle::Instance();
+  int positions = 0, optimal = 0;
+  for (unsigned int id = 0; id < TicTacToe::Game::kIDCount; ++id) {
+    const TicTacToe::Game game = TicTacToe::Game::FromID(id);
+    const int difference = __builtin_popcount(game.Tiles(TicTacToe::X)) -
+                           __builtin_popcount(game.Tiles(TicTacToe::O));
+    if ((difference != 0 && difference != 1) || game.Over()) {
+      continue;
+    }
+    const TicTacToe::Game::Position move =
+        TicTacToe::AINextMove(game, network);
+    ++positions;
+    if (oracle.OptimalMoves(game, TicTacToe::O) &
+        TicTacToe::Game::TileBit(move.first, move.second)) {
+      ++optimal;
+    }
+  }
+
+  EXPECT_GT(positions, 0);
+  EXPECT_DOUBLE_EQ(TicTacToe::SimpleNetworkOracleFitness(&network)(),
+                   static_cast<double>(optimal) / positions);
+}
@@ -0,0 +1,51 @@
+
+#include "tictactoe/opponent_table.h"
+#include "tictactoe/oracle.h"
+#include "gtest/gtest.h"
+
+TEST(OracleTest, ValueTest) {
+  const TicTacToe::Oracle& oracle = TicTacToe::Oracle::Instance();
+
+  // Every opening move keeps the draw.
+  TicTacToe::Game game;
+  EXPECT_EQ(oracle.Value(game, TicTacToe::X), 0);
+  EXPECT_EQ(oracle.OptimalMoves(game, TicTacToe::X),
+            TicTacToe::Game::kFullBoard);
+
+  // X wins fastest in (2, 0); O has to block there.
+  game.SetTile(0, 0, TicTacToe::X);
+  game.SetTile(1, 0, TicTacToe::X);
+  game.SetTile(1, 1, TicTacToe::O);
+  EXPECT_EQ(oracle.Value(game, TicTacToe::X), 10 - 4);
+  EXPECT_EQ(oracle.BestMove(game, TicTacToe::X),
+            TicTacToe::Game::Position(2, 0));
+  EXPECT_EQ(oracle.OptimalMoves(game, TicTacToe::O),
+            TicTacToe::Game::TileBit(2, 0));
+
+  // A finished game has no moves.
+  game.SetTile(2, 0, TicTacToe::X);
+  EXPECT_EQ(oracle.Value(game, TicTacToe::O), 4 - 10);
+  EXPECT_EQ(oracle.OptimalMoves(game, TicTacToe::O), 0);
+}
+
+// Perfect play never loses, no matter who starts.
+TEST(OracleTest, PerfectMoveTest) {
+  const TicTacToe::OpponentTable perfect(&TicTacToe::PerfectMove);
+  for (uint64_t seed = 0; seed < 20; ++seed) {
+    const TicTacToe::OpponentTable random(TicTacToe::SeededRandomPolicy(seed));
+    for (int o_starts = 0; o_starts < 2; ++o_starts) {
+      TicTacToe::Game game;
+      TicTacToe::Player to_move = (o_starts ? TicTacToe::O : TicTacToe::X);
+      while (!game.Over()) {
+        if (to_move == TicTacToe::X) {
+          game.SetTile(perfect.Move(game), TicTacToe::X);
+          to_move = TicTacToe::O;
+        } else {
+          game.SetTile(random.Move(game), TicTacToe::O);
+          to_move = TicTacToe::X;
+        }
+      }
+      EXPECT_NE(game.Winner(), TicTacToe::O);
+    }
+  }
+}
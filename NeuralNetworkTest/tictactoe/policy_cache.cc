@@ -0,0 +1,56 @@
+
+#include "tictactoe/policy_cache.h"
+
+namespace TicTacToe {
+
+PolicyCache::PolicyCache(unsigned int capacity) {
+  unsigned int size = 1;
+  while (size < capacity) {
+    size *= 2;
+  }
+  entries_.resize(size);
+}
+
+bool PolicyCache::Find(const PolicyFingerprint& fingerprint,
+                       double* score) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const Entry& entry = entries_[fingerprint.low & (entries_.size() - 1)];
+  if (entry.valid && entry.fingerprint == fingerprint) {
+    *score = entry.score;
+    ++hits_;
+    return true;
+  }
+  ++misses_;
+  return false;
+}
+
+void PolicyCache::Insert(const PolicyFingerprint& fingerprint, double score) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry& entry = entries_[fingerprint.low & (entries_.size() - 1)];
+  entry.fingerprint = fingerprint;
+  entry.score = score;
+  entry.valid = true;
+}
+
+unsigned int PolicyCache::hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+unsigned int PolicyCache::misses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+double SimpleNetworkPolicyFitness::operator()() const {
+  thread_local NetworkPolicy policy;
+  policy.Compute(*network_);
+
+  double score = 0.0;
+  if (!cache_->Find(policy.fingerprint(), &score)) {
+    score = (*score_)(policy);
+    cache_->Insert(policy.fingerprint(), score);
+  }
+  return score;
+}
+}
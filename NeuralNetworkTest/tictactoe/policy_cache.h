@@ -0,0 +1,64 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "nn/simple_network.h"
+#include "tictactoe/network_policy.h"
+
+namespace TicTacToe {
+
+// A bounded map from policy fingerprints to scores. It has a fixed number of
+// slots, chosen by the fingerprint, and a new entry replaces the one in its
+// slot. A cache must only be used with one score function. It can be shared
+// between threads.
+class PolicyCache {
+ public:
+  // The capacity is rounded up to a power of two.
+  explicit PolicyCache(unsigned int capacity = 1 << 16);
+
+  // Returns whether a score is stored for the fingerprint and writes it to
+  // *score if so.
+  bool Find(const PolicyFingerprint& fingerprint, double* score) const;
+
+  // Stores the score of a fingerprint.
+  void Insert(const PolicyFingerprint& fingerprint, double score);
+
+  // The number of successful and unsuccessful calls to Find.
+  unsigned int hits() const;
+  unsigned int misses() const;
+
+ private:
+  struct Entry {
+    PolicyFingerprint fingerprint;
+    double score = 0.0;
+    bool valid = false;
+  };
+
+  mutable std::mutex mutex_;
+  std::vector<Entry> entries_;
+  mutable unsigned int hits_ = 0;
+  mutable unsigned int misses_ = 0;
+};
+
+// Calculates a fitness score of this network from its policy, see
+// NetworkPolicy. Scores are memoized by policy fingerprint, so networks that
+// play like an already scored one only pay for computing the policy.
+struct SimpleNetworkPolicyFitness {
+ public:
+  // E.g. SlowPolicyScore or FastPolicyScore.
+  using PolicyScore = std::function<double(const NetworkPolicy&)>;
+
+  SimpleNetworkPolicyFitness(const SimpleNetwork* network,
+                             const PolicyScore* score, PolicyCache* cache)
+      : network_(network), score_(score), cache_(cache) {}
+
+  double operator()() const;
+
+ private:
+  const SimpleNetwork* network_;
+  const PolicyScore* score_;
+  PolicyCache* cache_;
+};
+}
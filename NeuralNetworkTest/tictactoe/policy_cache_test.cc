@@ -0,0 +1,55 @@
+
+#include "tictactoe/policy_cache.h"
+#include "gtest/gtest.h"
+
+TEST(PolicyCacheTest, FindAndInsertTest) {
+  TicTacToe::PolicyCache cache(3);
+  TicTacToe::PolicyFingerprint a, b, c;
+  a.low = 1;
+  b.low = 1;
+  b.high = 2;
+  c.low = 2;
+
+  double score = 0.0;
+  EXPECT_FALSE(cache.Find(a, &score));
+  cache.Insert(a, 1.5);
+  cache.Insert(c, 2.5);
+  EXPECT_TRUE(cache.Find(a, &score));
+  EXPECT_EQ(score, 1.5);
+  EXPECT_FALSE(cache.Find(b, &score));
+  EXPECT_TRUE(cache.Find(c, &score));
+  EXPECT_EQ(score, 2.5);
+
+  // a and b share a slot, so b replaces a.
+  cache.Insert(b, -1.0);
+  EXPECT_FALSE(cache.Find(a, &score));
+  EXPECT_TRUE(cache.Find(b, &score));
+  EXPECT_EQ(score, -1.0);
+  EXPECT_EQ(cache.hits(), 3);
+  EXPECT_EQ(cache.misses(), 3);
+}
+
+TEST(PolicyCacheTest, PolicyFitnessTest) {
+  SimpleNetwork network(std::vector<int>{10, 9});
+  network.AddConnection(SimpleNetwork::Edge(0, 9, 4), 1.0);
+  network.AddConnection(SimpleNetwork::Edge(0, 4, 0), -0.5);
+  network.AddConnection(SimpleNetwork::Edge(0, 4, 8), 0.5);
+  SimpleNetwork same_moves(std::vector<int>{10, 9});
+  same_moves.AddConnection(SimpleNetwork::Edge(0, 9, 4), 3.0);
+  same_moves.AddConnection(SimpleNetwork::Edge(0, 4, 0), -1.5);
+  same_moves.AddConnection(SimpleNetwork::Edge(0, 4, 8), 1.5);
+
+  int scored = 0;
+  const TicTacToe::SimpleNetworkPolicyFitness::PolicyScore score =
+      [&scored](const TicTacToe::NetworkPolicy& policy) {
+        ++scored;
+        return TicTacToe::SlowPolicyScore(policy);
+      };
+  TicTacToe::PolicyCache cache;
+  EXPECT_DOUBLE_EQ(
+      TicTacToe::SimpleNetworkPolicyFitness(&network, &score, &cache)(), -104);
+  EXPECT_DOUBLE_EQ(
+      TicTacToe::SimpleNetworkPolicyFitness(&same_moves, &score, &cache)(),
+      -104);
+  EXPECT_EQ(scored, 1);
+}
@@ -8,53 +8,90 @@
 namespace TicTacToe {
 Game::Position AINextMove(const Game& game, const SimpleNetwork& network) {
   try {
-    AssertThat(network.LayerSize(0), snowhouse::Equals(10u));
-    AssertThat(network.LayerSize(network.LayerNumber() - 1),
-               snowhouse::Equals(9u));
-    AssertThat(game.FreeMoves().size(), snowhouse::IsGreaterThan(0u));
+    AssertThat(game.FreeMoveRange().empty(), snowhouse::Equals(false));
   } catch (const snowhouse::AssertionException& ex) {
     std::cerr << __FILE__ << " " << __LINE__ << std::endl;
     std::cerr << ex.GetMessage() << std::endl;
     exit(1);
   }
 
-  std::vector<double> output = network.Forward(GameToNetworkInput(game));
+  return NetworkPlayer(&network).NextMove(game);
+}
 
-  // Make sure that no tile that is already taken will be selected.
-  const double min_value = *std::min_element(output.begin(), output.end());
-  const double below_min =
-      std::nextafter(min_value, -std::numeric_limits<double>::infinity());
-  for (int x = 0; x < 3; ++x) {
-    for (int y = 0; y < 3; ++y) {
-      if (!game.Tile(x, y) == None) {
-        output[x + y * 3] = below_min;
-      }
-    }
+NetworkPlayer::NetworkPlayer(const SimpleNetwork* network)
+    : network_(network), workspace_(*network) {
+  try {
+    AssertThat(network->LayerSize(0), snowhouse::Equals(10u));
+    AssertThat(network->LayerSize(network->LayerNumber() - 1),
+               snowhouse::Equals(9u));
+  } catch (const snowhouse::AssertionException& ex) {
+    std::cerr << __FILE__ << " " << __LINE__ << std::endl;
+    std::cerr << ex.GetMessage() << std::endl;
+    exit(1);
   }
+}
 
-  return OutputToPosition(output);
+NetworkPlayer::NetworkPlayer(const SimpleNetwork* network,
+                             ReducedPrecisionNetwork::Precision precision)
+    : NetworkPlayer(network) {
+  reduced_network_.reset(new ReducedPrecisionNetwork(*network, precision));
+  reduced_workspace_ = ReducedPrecisionNetwork::Workspace(*reduced_network_);
+}
+
+Game::Position NetworkPlayer::NextMove(const Game& game) {
+  GameToNetworkInput(game, input_.data());
+  if (reduced_network_) {
+    std::copy(input_.begin(), input_.end(), reduced_input_.begin());
+    reduced_network_->Forward(reduced_input_.data(), reduced_output_.data(),
+                              &reduced_workspace_);
+    return SelectMove(game, reduced_output_.data());
+  }
+  network_->Forward(input_.data(), output_.data(), &workspace_);
+  return SelectMove(game, output_.data());
 }
 
 std::vector<double> GameToNetworkInput(const Game& game) {
-  std::vector<double> input;
+  std::vector<double> input(10);
+  GameToNetworkInput(game, input.data());
+  return input;
+}
+
+void GameToNetworkInput(const Game& game, double* input) {
   for (int y = 0; y < 3; ++y) {
     for (int x = 0; x < 3; ++x) {
       const Player tile = game.Tile(x, y);
       switch (tile) {
         case X:
-          input.push_back(-1.0);
+          input[x + y * 3] = -1.0;
           break;
         case O:
-          input.push_back(1.0);
+          input[x + y * 3] = 1.0;
           break;
         default:
-          input.push_back(0.0);
+          input[x + y * 3] = 0.0;
           break;
       }
     }
   }
-  input.push_back(1.0);
-  return input;
+  input[9] = 1.0;
+}
+
+void GameToSparseNetworkInput(const Game& game,
+                              std::vector<SimpleNetwork::SparseInput>* input) {
+  input->clear();
+  for (int y = 0; y < 3; ++y) {
+    for (int x = 0; x < 3; ++x) {
+      const Player tile = game.Tile(x, y);
+      if (tile == X) {
+        input->push_back(SimpleNetwork::SparseInput{
+            static_cast<unsigned int>(x + y * 3), -1.0});
+      } else if (tile == O) {
+        input->push_back(SimpleNetwork::SparseInput{
+            static_cast<unsigned int>(x + y * 3), 1.0});
+      }
+    }
+  }
+  input->push_back(SimpleNetwork::SparseInput{9, 1.0});
 }
 
 Game::Position OutputToPosition(const std::vector<double>& output) {
@@ -64,35 +101,67 @@ Game::Position OutputToPosition(const std::vector<double>& output) {
   return Game::Position(position % 3, position / 3);
 }
 
+namespace {
+template <typename T>
+Game::Position SelectMoveFrom(const Game& game, const T* output) {
+  // Taken tiles are skipped, so they can never be selected.
+  const Game::TileMask free_tiles = game.Tiles(None);
+  int best = -1;
+  for (int i = 0; i < 9; ++i) {
+    if ((free_tiles & Game::TileBit(i % 3, i / 3)) &&
+        (best < 0 || output[i] > output[best])) {
+      best = i;
+    }
+  }
+  return Game::Position(best % 3, best / 3);
+}
+}
+
+Game::Position SelectMove(const Game& game, const double* output) {
+  return SelectMoveFrom(game, output);
+}
+
+Game::Position SelectMove(const Game& game, const float* output) {
+  return SelectMoveFrom(game, output);
+}
+
 double SimpleNetworkSlowFitness::operator()() const {
+  if (!player_.UsesReducedPrecision()) {
+    network_->Compile();
+  }
+
+  thread_local StateTable<double> fitness_memory;
+  fitness_memory.Clear();
+  fitness_memory_ = &fitness_memory;
+
   Game human_start;
   Game ai_start;
-  ai_start.SetTile(AINextMove(ai_start, *network_), O);
+  ai_start.SetTile(player_.NextMove(ai_start), O);
   return FitnessFrom(human_start) + FitnessFrom(ai_start);
 }
 
 double SimpleNetworkSlowFitness::FitnessFrom(const Game& game) const {
-  const unsigned int game_id = game.ID();
-  if (fitness_memory_.find(game_id) == fitness_memory_.end()) {
-    fitness_memory_[game_id] = ComputeFitness(game);
+  const double* fitness = fitness_memory_->Find(game);
+  if (fitness != nullptr) {
+    return *fitness;
   }
-  return fitness_memory_[game_id];
+  return fitness_memory_->Set(game, ComputeFitness(game));
 }
 
 double SimpleNetworkSlowFitness::ComputeFitness(const Game& game) const {
   double fitness_sum = 0.0;
-  for (const Game::Position& free_position : game.FreeMoves()) {
+  for (const Game::Position& free_position : game.FreeMoveRange()) {
     // Make the opponents move.
     Game next_state = game;
     next_state.SetTile(free_position, X);
-    if (next_state.FreeMoves().size() == 0) {
+    if (next_state.FreeMoveRange().empty()) {
       fitness_sum += EndedGameFitness(next_state);
       continue;
     }
 
     // Make the AI's move.
-    next_state.SetTile(AINextMove(next_state, *network_), O);
-    if (next_state.FreeMoves().size() == 0) {
+    next_state.SetTile(player_.NextMove(next_state), O);
+    if (next_state.FreeMoveRange().empty()) {
       fitness_sum += EndedGameFitness(next_state);
     } else {
       fitness_sum += FitnessFrom(next_state);
@@ -117,9 +186,11 @@ double SimpleNetworkSlowFitness::EndedGameFitness(const Game& game) const {
 }
 
 double SimpleNetworkFastFitness::operator()() const {
+  network_->Compile();
+
   Game human_start;
   Game ai_start;
-  ai_start.SetTile(AINextMove(ai_start, *network_), O);
+  ai_start.SetTile(player_.NextMove(ai_start), O);
   return FitnessFrom(human_start) + FitnessFrom(ai_start);
 }
 
@@ -127,57 +198,14 @@ double SimpleNetworkFastFitness::FitnessFrom(Game game) const {
   if (game.Over()) {
     return EndedGameFitness(game);
   }
-  game.SetTile(OpponentMove(game), X);
+  game.SetTile(opponent_->Move(game), X);
   if (game.Over()) {
     return EndedGameFitness(game);
   }
-  game.SetTile(AINextMove(game, *network_), O);
+  game.SetTile(player_.NextMove(game), O);
   return FitnessFrom(std::move(game));
 }
 
-Game::Position SimpleNetworkFastFitness::OpponentMove(const Game& game) const {
-  // Win if possible.
-  for (const std::array<Game::Position, 3>& winning_combination :
-       Game::WinningCombinations) {
-    Game::Position a = winning_combination[0], b = winning_combination[1],
-                   c = winning_combination[2];
-    if (game.Tile(a) == X && game.Tile(b) == X && game.Tile(c) == None) {
-      return c;
-    }
-    if (game.Tile(a) == X && game.Tile(b) == None && game.Tile(c) == X) {
-      return b;
-    }
-    if (game.Tile(a) == None && game.Tile(b) == X && game.Tile(c) == X) {
-      return a;
-    }
-  }
-
-  // Stop a victory if possible.
-  for (const std::array<Game::Position, 3>& winning_combination :
-       Game::WinningCombinations) {
-    Game::Position a = winning_combination[0], b = winning_combination[1],
-                   c = winning_combination[2];
-    if (game.Tile(a) == O && game.Tile(b) == O && game.Tile(c) == None) {
-      return c;
-    }
-    if (game.Tile(a) == O && game.Tile(b) == None && game.Tile(c) == O) {
-      return b;
-    }
-    if (game.Tile(a) == None && game.Tile(b) == O && game.Tile(c) == O) {
-      return a;
-    }
-  }
-
-  // Set in the center if it is free.
-  if (game.Tile(1, 1) == None) {
-    return Game::Position(1, 1);
-  }
-
-  // Choose a the first free position. (random is not an option beause fitness
-  // needs to be deterministic)
-  return game.FreeMoves().front();
-}
-
 double SimpleNetworkFastFitness::EndedGameFitness(const Game& game) const {
   // Player won.
   if (game.Winner() == X) {
@@ -1,26 +1,80 @@
 #pragma once
 
-#include <unordered_map>
+#include <array>
+#include <memory>
 
+#include "nn/reduced_precision_network.h"
 #include "nn/simple_network.h"
 #include "tictactoe/game.h"
+#include "tictactoe/opponent_table.h"
+#include "tictactoe/state_table.h"
 
 namespace TicTacToe {
 // Given a neural network and a TicTacToe game, calculates the next move from
-// the network.
+// the network. For many moves of the same network, NetworkPlayer is faster.
 Game::Position AINextMove(const Game& game, const SimpleNetwork& network);
 
+// Calculates the moves of one network without allocating. The shape of the
+// network is checked once on construction instead of on every move. The
+// network must outlive the player.
+class NetworkPlayer {
+ public:
+  explicit NetworkPlayer(const SimpleNetwork* network);
+
+  // Opt-in: plays with a ReducedPrecisionNetwork copy of the network, which is
+  // made once here. The moves only differ from the ones in double precision
+  // where outputs nearly tie. Later changes to the network are not seen.
+  NetworkPlayer(const SimpleNetwork* network,
+                ReducedPrecisionNetwork::Precision precision);
+
+  // The same move as AINextMove. The game must have a free tile.
+  Game::Position NextMove(const Game& game);
+
+  bool UsesReducedPrecision() const { return reduced_network_ != nullptr; }
+
+ private:
+  const SimpleNetwork* network_;
+  SimpleNetwork::Workspace workspace_;
+  std::array<double, 10> input_;
+  std::array<double, 9> output_;
+
+  // Only set for reduced precision.
+  std::unique_ptr<const ReducedPrecisionNetwork> reduced_network_;
+  ReducedPrecisionNetwork::Workspace reduced_workspace_;
+  std::array<float, 10> reduced_input_;
+  std::array<float, 9> reduced_output_;
+};
+
 // Converts the state of a TTT game to the input of a network.
 std::vector<double> GameToNetworkInput(const Game& game);
+// Writes the same input to an array of 10 values.
+void GameToNetworkInput(const Game& game, double* input);
+
+// Converts the state of a TTT game to a sparse network input which only lists
+// the occupied tiles and the constant bias component. The vector is cleared
+// first, so it can be reused between calls without allocating.
+void GameToSparseNetworkInput(const Game& game,
+                              std::vector<SimpleNetwork::SparseInput>* input);
 
 // Converts the output of a network to the position in a game.
 Game::Position OutputToPosition(const std::vector<double>& output);
 
+// Selects the free tile with the highest output value. Ties go to the tile
+// with the lower output index. The game must have a free tile.
+Game::Position SelectMove(const Game& game, const double* output);
+Game::Position SelectMove(const Game& game, const float* output);
+
 // Calculates a fitness score of this network by having it play against all
 // possible strategies.
 struct SimpleNetworkSlowFitness {
  public:
-  SimpleNetworkSlowFitness(const SimpleNetwork* network) : network_(network) {}
+  SimpleNetworkSlowFitness(const SimpleNetwork* network)
+      : network_(network), player_(network) {}
+  // Plays in reduced precision, see NetworkPlayer. The network makes hundreds
+  // of moves here, so the conversion is cheap in comparison.
+  SimpleNetworkSlowFitness(const SimpleNetwork* network,
+                           ReducedPrecisionNetwork::Precision precision)
+      : network_(network), player_(network, precision) {}
 
   double operator()() const;
 
@@ -33,14 +87,21 @@ struct SimpleNetworkSlowFitness {
   double EndedGameFitness(const Game& game) const;
 
   const SimpleNetwork* network_;
-  mutable std::unordered_map<unsigned int, double> fitness_memory_;
+  mutable NetworkPlayer player_;
+  // Points to a table owned by the evaluating thread while operator() runs.
+  mutable StateTable<double>* fitness_memory_ = nullptr;
 };
 
 // Calculates a fitness score of this network by having it play against one
-// specific predefined AI.
+// specific deterministic AI. By default, this is OpponentTable::Scripted().
 struct SimpleNetworkFastFitness {
  public:
-  SimpleNetworkFastFitness(const SimpleNetwork* network) : network_(network) {}
+  SimpleNetworkFastFitness(const SimpleNetwork* network,
+                           const OpponentTable* opponent = nullptr)
+      : network_(network),
+        player_(network),
+        opponent_(opponent != nullptr ? opponent
+                                      : &OpponentTable::Scripted()) {}
 
   double operator()() const;
 
@@ -48,11 +109,11 @@ struct SimpleNetworkFastFitness {
   // Compute the fitness starting from a given game. This assumes that its the
   // opponents turn.
   double FitnessFrom(Game game) const;
-  // The next move of the predefined ai.
-  Game::Position OpponentMove(const Game& game) const;
   // The final fitness score of a game that has ended.
   double EndedGameFitness(const Game& game) const;
 
   const SimpleNetwork* network_;
+  mutable NetworkPlayer player_;
+  const OpponentTable* opponent_;
 };
 }
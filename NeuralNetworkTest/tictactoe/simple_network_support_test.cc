@@ -1,5 +1,10 @@
 
+#include <cmath>
+#include <random>
+
+#include "nn/simple_network_testing.h"
 #include "simple_network_support.h"
+#include "tictactoe/state_graph.h"
 #include "gtest/gtest.h"
 
 namespace {
@@ -13,6 +18,45 @@ SimpleNetwork test_network() {
 
   return network;
 }
+
+// The number of reachable boards with a free tile on which a reduced precision
+// player moves like the double precision one, and the number of all such
+// boards.
+std::pair<int, int> ReducedPrecisionAgreement(
+    const SimpleNetwork& network,
+    ReducedPrecisionNetwork::Precision precision) {
+  const TicTacToe::StateGraph& graph = TicTacToe::StateGraph::Instance();
+  TicTacToe::NetworkPlayer player(&network);
+  TicTacToe::NetworkPlayer reduced_player(&network, precision);
+  int agreements = 0, boards = 0;
+  for (unsigned int i = 0; i < graph.size(); ++i) {
+    const TicTacToe::Game& game = graph.node(i).game;
+    if (game.FreeMoveRange().empty()) {
+      continue;
+    }
+    ++boards;
+    if (reduced_player.NextMove(game) == player.NextMove(game)) {
+      ++agreements;
+    }
+  }
+  return std::make_pair(agreements, boards);
+}
+
+// The ratio of boards on which random networks of the shape used in the
+// experiment move the same in reduced and double precision.
+double ReducedPrecisionAgreement(ReducedPrecisionNetwork::Precision precision) {
+  std::mt19937 generator(42);
+  int agreements = 0, boards = 0;
+  for (int i = 0; i < 20; ++i) {
+    const SimpleNetwork network = simple_network_testing::RandomNetwork(
+        {10, 12, 12, 9}, 0.4, &generator);
+    const std::pair<int, int> result =
+        ReducedPrecisionAgreement(network, precision);
+    agreements += result.first;
+    boards += result.second;
+  }
+  return static_cast<double>(agreements) / boards;
+}
 }
 
 // Make sure that "AINextMove" works correctly by calling it on a small
@@ -34,6 +78,110 @@ TEST(SimpleNetworkSupportTest, SimpleNetworkFitnessTest) {
 
 TEST(SimpleNetworkSupportTest, AINextMoveTest) {
   SimpleNetwork network = test_network();
-  const double fitness = TicTacToe::SimpleNetworkFitness(&network)();
+  const double fitness = TicTacToe::SimpleNetworkSlowFitness(&network)();
   EXPECT_DOUBLE_EQ(fitness, -104);
 }
+
+TEST(SimpleNetworkSupportTest, GameToSparseNetworkInputTest) {
+  SimpleNetwork network = test_network();
+  network.AddConnection(SimpleNetwork::Edge(0, 2, 1), 0.25);
+  network.AddConnection(SimpleNetwork::Edge(0, 6, 7), -0.75);
+
+  TicTacToe::Game game;
+  game.SetTile(1, 1, TicTacToe::X);
+  game.SetTile(2, 0, TicTacToe::O);
+  game.SetTile(0, 2, TicTacToe::X);
+
+  // The sparse input has to lead to the same output as the dense one.
+  std::vector<SimpleNetwork::SparseInput> sparse_input;
+  TicTacToe::GameToSparseNetworkInput(game, &sparse_input);
+  EXPECT_EQ(sparse_input.size(), 4);
+  SimpleNetwork::Workspace workspace(network);
+  std::vector<double> sparse_output(9);
+  network.Forward(sparse_input, sparse_output.data(), &workspace);
+  const std::vector<double> dense_output =
+      network.Forward(TicTacToe::GameToNetworkInput(game));
+  for (int i = 0; i < 9; ++i) {
+    EXPECT_DOUBLE_EQ(sparse_output[i], dense_output[i]);
+  }
+}
+
+TEST(SimpleNetworkSupportTest, NetworkPlayerTest) {
+  std::mt19937 generator(21);
+  std::uniform_real_distribution<double> weight(-1.0, 1.0);
+  SimpleNetwork network(std::vector<int>{10, 5, 9});
+  for (const SimpleNetwork::Edge& edge : network.AllEdges()) {
+    network.AddConnection(edge, weight(generator));
+  }
+
+  // The player has to move like AINextMove on every board with a free tile.
+  TicTacToe::NetworkPlayer player(&network);
+  for (unsigned int id = 0; id < TicTacToe::Game::kIDCount; ++id) {
+    const TicTacToe::Game game = TicTacToe::Game::FromID(id);
+    if (!game.FreeMoveRange().empty()) {
+      const TicTacToe::Game::Position move = player.NextMove(game);
+      EXPECT_EQ(move, TicTacToe::AINextMove(game, network));
+      EXPECT_EQ(game.Tile(move), TicTacToe::None);
+    }
+  }
+}
+
+TEST(SimpleNetworkSupportTest, CompiledSelectMoveTest) {
+  // The fitness functions compile the networks while AINextMove and
+  // PlayAgainstAI do not, so both have to compute the same outputs and choose
+  // the same moves. Sparse networks have many nodes without a path from the
+  // input.
+  std::mt19937 generator(29);
+  for (int i = 0; i < 20; ++i) {
+    SimpleNetwork network = simple_network_testing::RandomNetwork(
+        {10, 8, 8, 9}, i % 2 ? 0.15 : 0.6, &generator);
+    network.activation_function = [](double x) { return std::tanh(x) + 0.1; };
+    SimpleNetwork compiled = network;
+    compiled.Compile();
+
+    SimpleNetwork::Workspace workspace(network);
+    std::vector<double> input(10), output(9), compiled_output(9);
+    for (unsigned int id = 0; id < TicTacToe::Game::kIDCount; ++id) {
+      const TicTacToe::Game game = TicTacToe::Game::FromID(id);
+      if (game.FreeMoveRange().empty()) {
+        continue;
+      }
+      TicTacToe::GameToNetworkInput(game, input.data());
+      network.Forward(input.data(), output.data(), &workspace);
+      compiled.Forward(input.data(), compiled_output.data(), &workspace);
+      EXPECT_EQ(compiled_output, output);
+      EXPECT_EQ(TicTacToe::SelectMove(game, compiled_output.data()),
+                TicTacToe::SelectMove(game, output.data()));
+    }
+  }
+}
+
+// Reduced precision players may only choose differently where outputs nearly
+// tie.
+TEST(SimpleNetworkSupportTest, Float32NetworkPlayerTest) {
+  EXPECT_GE(ReducedPrecisionAgreement(ReducedPrecisionNetwork::FLOAT32), 0.999);
+}
+
+TEST(SimpleNetworkSupportTest, Int8NetworkPlayerTest) {
+  EXPECT_GE(ReducedPrecisionAgreement(ReducedPrecisionNetwork::INT8), 0.98);
+}
+
+TEST(SimpleNetworkSupportTest, ReducedPrecisionSlowFitnessTest) {
+  // The slow fitness visits every reachable board, so it is the same for
+  // networks whose moves agree everywhere.
+  std::mt19937 generator(43);
+  int checked_networks = 0;
+  for (int i = 0; i < 10; ++i) {
+    const SimpleNetwork network = simple_network_testing::RandomNetwork(
+        {10, 12, 12, 9}, 0.4, &generator);
+    const std::pair<int, int> agreement =
+        ReducedPrecisionAgreement(network, ReducedPrecisionNetwork::FLOAT32);
+    if (agreement.first == agreement.second) {
+      ++checked_networks;
+      EXPECT_EQ(TicTacToe::SimpleNetworkSlowFitness(
+                    &network, ReducedPrecisionNetwork::FLOAT32)(),
+                TicTacToe::SimpleNetworkSlowFitness(&network)());
+    }
+  }
+  EXPECT_GT(checked_networks, 0);
+}
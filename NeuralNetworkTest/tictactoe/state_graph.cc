@@ -0,0 +1,81 @@
+
+#include <algorithm>
+
+#include "tictactoe/state_graph.h"
+
+namespace TicTacToe {
+
+namespace {
+// The score of a game that ends with the given board, see
+// SimpleNetworkSlowFitness.
+double FinalScore(const Game& game) {
+  if (game.Winner() == X) {
+    return game.Turns() - 10;
+  }
+  if (game.Winner() == O) {
+    return 10 - game.Turns();
+  }
+  return 0.0;
+}
+
+// Whether a board can be reached by taking turns.
+bool IsAlternating(const Game& game) {
+  const int difference = __builtin_popcount(game.Tiles(X)) -
+                         __builtin_popcount(game.Tiles(O));
+  return difference >= -1 && difference <= 1;
+}
+}
+
+const StateGraph::NodeIndex StateGraph::kNoNode;
+
+const StateGraph& StateGraph::Instance() {
+  static const StateGraph graph;
+  return graph;
+}
+
+StateGraph::StateGraph()
+    : turns_offsets_(11, 0), id_to_node_(Game::kIDCount, kNoNode) {
+  // Collect the nodes, ordered by turns and then by ID.
+  for (unsigned int id = 0; id < Game::kIDCount; ++id) {
+    const Game game = Game::FromID(id);
+    if (IsAlternating(game)) {
+      nodes_.push_back(Node{game, id, game.Turns(), FinalScore(game), 0, 0});
+    }
+  }
+  std::stable_sort(nodes_.begin(), nodes_.end(),
+                   [](const Node& lhs, const Node& rhs) {
+                     return lhs.turns < rhs.turns;
+                   });
+  for (NodeIndex i = 0; i < nodes_.size(); ++i) {
+    id_to_node_[nodes_[i].id] = i;
+    ++turns_offsets_[nodes_[i].turns + 1];
+  }
+  for (unsigned int turns = 1; turns < turns_offsets_.size(); ++turns) {
+    turns_offsets_[turns] += turns_offsets_[turns - 1];
+  }
+
+  // Link the moves of X.
+  for (NodeIndex i = 0; i < nodes_.size(); ++i) {
+    nodes_[i].x_successors_begin = x_successors_.size();
+    for (const Game::Position& tile : nodes_[i].game.FreeMoveRange()) {
+      const NodeIndex successor = Successor(i, tile, X);
+      if (successor != kNoNode) {
+        x_successors_.push_back(successor);
+      }
+    }
+    nodes_[i].x_successors_end = x_successors_.size();
+  }
+}
+
+StateGraph::NodeIndex StateGraph::Find(const Game& game) const {
+  return id_to_node_[game.ID()];
+}
+
+StateGraph::NodeIndex StateGraph::Successor(NodeIndex index,
+                                            const Game::Position& tile,
+                                            Player player) const {
+  Game game = nodes_[index].game;
+  game.SetTile(tile, player);
+  return Find(game);
+}
+}
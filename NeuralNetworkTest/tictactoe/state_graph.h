@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "tictactoe/game.h"
+
+namespace TicTacToe {
+
+// The graph of all boards on which the numbers of X and O tiles differ by at
+// most one, i.e. all boards that can come up while X and O take turns, no
+// matter who started. Games are not stopped when a player wins, matching the
+// way SimpleNetworkSlowFitness explores them. The graph is built once and
+// shared by all users.
+class StateGraph {
+ public:
+  using NodeIndex = uint32_t;
+  static const NodeIndex kNoNode = ~NodeIndex{0};
+
+  struct Node {
+    Game game;
+    unsigned int id;
+    int turns;
+    // The score of this board if the game ends here, from the point of view
+    // of O: 10 - turns if O won, turns - 10 if X won and 0 otherwise.
+    double final_score;
+    // The range of the successors in x_successors_ in which X took a tile.
+    unsigned int x_successors_begin;
+    unsigned int x_successors_end;
+  };
+
+  // The graph, which is built on the first call.
+  static const StateGraph& Instance();
+
+  unsigned int size() const { return nodes_.size(); }
+  const Node& node(NodeIndex index) const { return nodes_[index]; }
+
+  // The nodes are ordered by the number of turns. These are the first node
+  // with the given number of turns and the first node after them.
+  NodeIndex TurnsBegin(int turns) const { return turns_offsets_[turns]; }
+  NodeIndex TurnsEnd(int turns) const { return turns_offsets_[turns + 1]; }
+
+  // Returns the node of a game or kNoNode if the game is not in the graph.
+  NodeIndex Find(const Game& game) const;
+
+  // Returns the node after a player took a free tile, or kNoNode if the
+  // resulting game is not in the graph.
+  NodeIndex Successor(NodeIndex index, const Game::Position& tile,
+                      Player player) const;
+
+  // The successors of a node in which X took a tile, in the order of the free
+  // tiles of Game::FreeMoveRange. Empty if X already has more tiles than O.
+  const NodeIndex* XSuccessorsBegin(NodeIndex index) const {
+    return x_successors_.data() + nodes_[index].x_successors_begin;
+  }
+  const NodeIndex* XSuccessorsEnd(NodeIndex index) const {
+    return x_successors_.data() + nodes_[index].x_successors_end;
+  }
+
+ private:
+  StateGraph();
+
+  std::vector<Node> nodes_;
+  std::vector<unsigned int> turns_offsets_;
+  std::vector<NodeIndex> x_successors_;
+  // The node of each game ID.
+  std::vector<NodeIndex> id_to_node_;
+};
+}
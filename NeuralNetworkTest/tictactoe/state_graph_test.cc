@@ -0,0 +1,56 @@
+
+#include "tictactoe/state_graph.h"
+#include "gtest/gtest.h"
+
+TEST(StateGraphTest, NodesTest) {
+  const TicTacToe::StateGraph& graph = TicTacToe::StateGraph::Instance();
+  EXPECT_EQ(&graph, &TicTacToe::StateGraph::Instance());
+
+  // The empty board, the 9 boards with one X and the 9 boards with one O.
+  EXPECT_EQ(graph.TurnsBegin(0), 0);
+  EXPECT_EQ(graph.TurnsEnd(0), 1);
+  EXPECT_EQ(graph.TurnsEnd(1) - graph.TurnsBegin(1), 18);
+  EXPECT_EQ(graph.TurnsEnd(9), graph.size());
+
+  for (TicTacToe::StateGraph::NodeIndex i = 0; i < graph.size(); ++i) {
+    const TicTacToe::StateGraph::Node& node = graph.node(i);
+    EXPECT_EQ(graph.Find(node.game), i);
+    EXPECT_EQ(node.id, node.game.ID());
+    EXPECT_EQ(node.turns, node.game.Turns());
+    EXPECT_GE(i, graph.TurnsBegin(node.turns));
+    EXPECT_LT(i, graph.TurnsEnd(node.turns));
+  }
+}
+
+TEST(StateGraphTest, SuccessorTest) {
+  const TicTacToe::StateGraph& graph = TicTacToe::StateGraph::Instance();
+  TicTacToe::Game game;
+  game.SetTile(1, 1, TicTacToe::X);
+  const TicTacToe::StateGraph::NodeIndex index = graph.Find(game);
+  ASSERT_NE(index, TicTacToe::StateGraph::kNoNode);
+
+  // X can not move twice in a row.
+  EXPECT_EQ(graph.XSuccessorsBegin(index), graph.XSuccessorsEnd(index));
+  EXPECT_EQ(graph.Successor(index, TicTacToe::Game::Position(0, 0),
+                            TicTacToe::X),
+            TicTacToe::StateGraph::kNoNode);
+
+  // O can, and then X has one successor per free tile.
+  game.SetTile(0, 2, TicTacToe::O);
+  const TicTacToe::StateGraph::NodeIndex next = graph.Successor(
+      index, TicTacToe::Game::Position(0, 2), TicTacToe::O);
+  ASSERT_EQ(next, graph.Find(game));
+  EXPECT_EQ(graph.XSuccessorsEnd(next) - graph.XSuccessorsBegin(next), 7);
+  for (const TicTacToe::StateGraph::NodeIndex* successor =
+           graph.XSuccessorsBegin(next);
+       successor != graph.XSuccessorsEnd(next); ++successor) {
+    EXPECT_EQ(graph.node(*successor).turns, 3);
+  }
+
+  // Final scores are given from O's point of view.
+  game.SetTile(0, 0, TicTacToe::X);
+  game.SetTile(1, 0, TicTacToe::O);
+  game.SetTile(2, 2, TicTacToe::X);
+  ASSERT_NE(graph.Find(game), TicTacToe::StateGraph::kNoNode);
+  EXPECT_EQ(graph.node(graph.Find(game)).final_score, 5 - 10);
+}
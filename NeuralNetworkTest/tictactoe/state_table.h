@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "tictactoe/game.h"
+
+namespace TicTacToe {
+
+// Maps game states to values. The table is dense over all game IDs, so lookups
+// neither hash nor allocate. Clearing only advances a generation stamp, so one
+// table can be reused for many evaluations, e.g. one per thread.
+template <typename T>
+class StateTable {
+ public:
+  enum KeyMode {
+    // Every game state has its own entry.
+    BOARD = 0,
+    // Games which are rotations or reflections of each other share an entry.
+    // Only suitable for values which are invariant under these symmetries.
+    CANONICAL = 1
+  };
+
+  explicit StateTable(KeyMode key_mode = BOARD);
+
+  KeyMode key_mode() const { return key_mode_; }
+
+  // The index of the entry of a game.
+  unsigned int Key(const Game& game) const;
+
+  // Removes all entries in constant time.
+  void Clear();
+
+  // Returns the value stored for a game, or nullptr if there is none.
+  const T* Find(const Game& game) const;
+  T* Find(const Game& game);
+
+  // Stores a value for a game and returns a reference to it.
+  T& Set(const Game& game, T value);
+
+ private:
+  KeyMode key_mode_;
+  std::vector<T> values_;
+  // An entry is valid iff its stamp equals the current one.
+  std::vector<uint32_t> stamps_;
+  uint32_t stamp_ = 1;
+};
+}
+
+#include "tictactoe/state_table.impl.h"
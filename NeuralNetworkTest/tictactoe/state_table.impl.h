@@ -0,0 +1,45 @@
+
+#include <algorithm>
+#include <utility>
+
+namespace TicTacToe {
+
+template <typename T>
+StateTable<T>::StateTable(KeyMode key_mode)
+    : key_mode_(key_mode), values_(Game::kIDCount), stamps_(Game::kIDCount) {}
+
+template <typename T>
+unsigned int StateTable<T>::Key(const Game& game) const {
+  return key_mode_ == CANONICAL ? game.CanonicalID() : game.ID();
+}
+
+template <typename T>
+void StateTable<T>::Clear() {
+  ++stamp_;
+  // After a wrap around, old stamps could become valid again.
+  if (stamp_ == 0) {
+    std::fill(stamps_.begin(), stamps_.end(), 0);
+    stamp_ = 1;
+  }
+}
+
+template <typename T>
+const T* StateTable<T>::Find(const Game& game) const {
+  const unsigned int key = Key(game);
+  return stamps_[key] == stamp_ ? &values_[key] : nullptr;
+}
+
+template <typename T>
+T* StateTable<T>::Find(const Game& game) {
+  const unsigned int key = Key(game);
+  return stamps_[key] == stamp_ ? &values_[key] : nullptr;
+}
+
+template <typename T>
+T& StateTable<T>::Set(const Game& game, T value) {
+  const unsigned int key = Key(game);
+  stamps_[key] = stamp_;
+  values_[key] = std::move(value);
+  return values_[key];
+}
+}
@@ -0,0 +1,40 @@
+
+#include "tictactoe/state_table.h"
+#include "gtest/gtest.h"
+
+TEST(StateTableTest, FindAndSetTest) {
+  TicTacToe::StateTable<double> table;
+  TicTacToe::Game game1, game2;
+  game2.SetTile(0, 1, TicTacToe::X);
+
+  EXPECT_EQ(table.Find(game1), nullptr);
+  table.Set(game1, 1.5);
+  ASSERT_NE(table.Find(game1), nullptr);
+  EXPECT_EQ(*table.Find(game1), 1.5);
+  EXPECT_EQ(table.Find(game2), nullptr);
+
+  // Clearing removes all entries.
+  table.Clear();
+  EXPECT_EQ(table.Find(game1), nullptr);
+  table.Set(game2, -2.0);
+  EXPECT_EQ(*table.Find(game2), -2.0);
+}
+
+TEST(StateTableTest, CanonicalTest) {
+  TicTacToe::StateTable<int> board_table;
+  TicTacToe::StateTable<int> canonical_table(
+      TicTacToe::StateTable<int>::CANONICAL);
+
+  // Corner openings are the same state up to symmetry.
+  TicTacToe::Game game1, game2, game3;
+  game1.SetTile(0, 0, TicTacToe::X);
+  game2.SetTile(2, 0, TicTacToe::X);
+  game3.SetTile(1, 0, TicTacToe::X);
+  board_table.Set(game1, 1);
+  canonical_table.Set(game1, 1);
+
+  EXPECT_EQ(board_table.Find(game2), nullptr);
+  ASSERT_NE(canonical_table.Find(game2), nullptr);
+  EXPECT_EQ(*canonical_table.Find(game2), 1);
+  EXPECT_EQ(canonical_table.Find(game3), nullptr);
+}
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "util/concurrency/thread_pool.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// Busy work of a given cost, standing in for one fitness evaluation.
+double Work(int cost) {
+  double x = 0.0;
+  for (int i = 0; i < cost * 1000; ++i) {
+    x += 1.0 / (i + 1.0);
+  }
+  return x;
+}
+
+// Like a generation of fitness evaluations: most are cheap, some are 50 times
+// as expensive, and the expensive ones are clustered because similar
+// specimens are next to each other.
+std::vector<int> TaskCosts() {
+  std::vector<int> costs(512, 1);
+  for (int i = 0; i < 32; ++i) {
+    costs[i] = 50;
+  }
+  return costs;
+}
+
+// Splits the tasks into one contiguous chunk per thread.
+void RunStatic(const std::vector<int>& costs, unsigned int threads,
+               std::vector<double>* results) {
+  std::vector<std::thread> workers;
+  const int chunk = (costs.size() + threads - 1) / threads;
+  for (unsigned int t = 0; t < threads; ++t) {
+    workers.emplace_back([&costs, results, chunk, t]() {
+      const int end = std::min<int>(costs.size(), (t + 1) * chunk);
+      for (int i = t * chunk; i < end; ++i) {
+        (*results)[i] = Work(costs[i]);
+      }
+    });
+  }
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+}
+
+void RunStealing(const std::vector<int>& costs,
+                 util::concurrency::ThreadPool* pool,
+                 std::vector<double>* results) {
+  util::concurrency::ParallelFor(pool, 0, costs.size(), 1,
+                                 [&costs, results](int i) {
+                                   (*results)[i] = Work(costs[i]);
+                                 });
+}
+
+// Prints the median and the slowest of the wall times of several runs.
+template <typename Run>
+void Measure(const char* name, int runs, const Run& run) {
+  std::vector<double> milliseconds;
+  for (int i = 0; i < runs; ++i) {
+    const Clock::time_point start = Clock::now();
+    run();
+    milliseconds.push_back(std::chrono::duration<double, std::milli>(
+                               Clock::now() - start)
+                               .count());
+  }
+  std::sort(milliseconds.begin(), milliseconds.end());
+  std::cout << name << ": median " << milliseconds[runs / 2] << " ms, max "
+            << milliseconds.back() << " ms" << std::endl;
+}
+}
+
+// Usage: benchmark [threads]
+// Without a positive number of threads, one per hardware thread is used, like
+// for ThreadPool.
+int main(int argc, char** argv) {
+  const int requested_threads = (argc > 1 ? std::atoi(argv[1]) : 0);
+  const unsigned int threads =
+      (requested_threads > 0
+           ? requested_threads
+           : std::max(1u, std::thread::hardware_concurrency()));
+  const std::vector<int> costs = TaskCosts();
+  std::vector<double> results(costs.size());
+  util::concurrency::ThreadPool pool(threads);
+  std::cout << threads << " threads, " << costs.size() << " tasks"
+            << std::endl;
+
+  // Static chunking can not finish before its most expensive chunk.
+  const int chunk = (costs.size() + threads - 1) / threads;
+  int total_cost = 0, largest_chunk_cost = 0;
+  for (unsigned int begin = 0; begin < costs.size(); begin += chunk) {
+    const int end = std::min<int>(costs.size(), begin + chunk);
+    const int cost = std::accumulate(costs.begin() + begin,
+                                     costs.begin() + end, 0);
+    total_cost += cost;
+    largest_chunk_cost = std::max(largest_chunk_cost, cost);
+  }
+  std::cout << "largest chunk: " << largest_chunk_cost
+            << " units, average per thread: "
+            << static_cast<double>(total_cost) / threads << " units"
+            << std::endl;
+  Measure("static chunks", 20,
+          [&]() { RunStatic(costs, threads, &results); });
+  Measure("work stealing", 20,
+          [&]() { RunStealing(costs, &pool, &results); });
+  return 0;
+}
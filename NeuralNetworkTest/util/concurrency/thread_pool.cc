@@ -0,0 +1,138 @@
+#include "util/concurrency/thread_pool.h"
+
+namespace util {
+namespace concurrency {
+
+namespace {
+// The pool and deque index of the current thread if it is a worker.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local unsigned int current_queue = 0;
+
+// The number of times TaskGroup::Wait looks for a task in vain before it
+// sleeps. Groups often finish shortly after their last task was taken.
+const int kSpinRounds = 64;
+}
+
+ThreadPool::ThreadPool(unsigned int threads) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (unsigned int i = 0; i <= threads; ++i) {
+    queues_.emplace_back(new Queue);
+  }
+  for (unsigned int i = 0; i < threads; ++i) {
+    threads_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+ThreadPool* ThreadPool::Default() {
+  static ThreadPool pool;
+  return &pool;
+}
+
+void ThreadPool::Push(Task task) {
+  Queue& queue = *queues_[QueueIndex()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  queued_.fetch_add(1);
+
+  // Taking the lock makes sure that a worker that is about to sleep either
+  // sees the new task or gets the notification.
+  { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+  wake_.notify_one();
+}
+
+bool ThreadPool::RunOne() {
+  const unsigned int own = QueueIndex();
+  Task task;
+  bool found = false;
+  {
+    Queue& queue = *queues_[own];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      found = true;
+    }
+  }
+  for (unsigned int i = 1; !found && i < queues_.size(); ++i) {
+    Queue& queue = *queues_[(own + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      found = true;
+    }
+  }
+  if (!found) {
+    return false;
+  }
+
+  queued_.fetch_sub(1);
+  task.function();
+  if (task.group->pending_.fetch_sub(1) == 1) {
+    // The group may be destroyed as soon as its waiter sees this, so only the
+    // pool is touched from here on.
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    wake_.notify_all();
+  }
+  return true;
+}
+
+unsigned int ThreadPool::QueueIndex() const {
+  return (current_pool == this ? current_queue : queues_.size() - 1);
+}
+
+void ThreadPool::WorkerLoop(unsigned int index) {
+  current_pool = this;
+  current_queue = index;
+  for (;;) {
+    if (RunOne()) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_.wait(lock, [this]() { return stop_ || queued_.load() > 0; });
+    if (stop_) {
+      return;
+    }
+  }
+}
+
+void TaskGroup::Run(std::function<void()> task) {
+  pending_.fetch_add(1);
+  pool_->Push(ThreadPool::Task{std::move(task), this});
+}
+
+void TaskGroup::Wait() {
+  int idle_rounds = 0;
+  while (pending_.load() > 0) {
+    if (pool_->RunOne()) {
+      idle_rounds = 0;
+    } else if (++idle_rounds < kSpinRounds) {
+      std::this_thread::yield();
+    } else {
+      // The remaining tasks run on other threads. Sleep until they finish or
+      // new tasks can be run here.
+      std::unique_lock<std::mutex> lock(pool_->sleep_mutex_);
+      pool_->wake_.wait(lock, [this]() {
+        return pending_.load() == 0 || pool_->queued_.load() > 0;
+      });
+      idle_rounds = 0;
+    }
+  }
+}
+}
+}
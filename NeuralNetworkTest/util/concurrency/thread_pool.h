@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util {
+namespace concurrency {
+
+class TaskGroup;
+
+// A pool of worker threads that run tasks with work stealing. Each worker has
+// its own deque of tasks. Tasks that are started by a worker go to the back of
+// its deque and the worker runs them last in, first out, so recursively split
+// work stays local. Idle workers steal from the front of the other deques,
+// which holds the oldest and usually the largest tasks. Tasks are started and
+// waited for with a TaskGroup.
+class ThreadPool {
+ public:
+  // Creates a pool with the given number of worker threads, or one per
+  // hardware thread if it is 0. Threads that wait for a TaskGroup run tasks
+  // as well, so a pool without workers runs everything on the waiting thread.
+  explicit ThreadPool(unsigned int threads = 0);
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Stops the workers. All task groups must have finished.
+  ~ThreadPool();
+
+  // The number of worker threads.
+  unsigned int size() const { return threads_.size(); }
+
+  // A pool with one worker per hardware thread that is shared by the whole
+  // program.
+  static ThreadPool* Default();
+
+ private:
+  friend class TaskGroup;
+
+  struct Task {
+    std::function<void()> function;
+    TaskGroup* group;
+  };
+
+  // The deque of a worker. The last one is shared by all threads that are not
+  // workers of this pool.
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  // Adds a task to the deque of the current thread.
+  void Push(Task task);
+
+  // Runs one task, preferring the back of the deque of the current thread and
+  // stealing from the front of the others. Returns false if there was none.
+  bool RunOne();
+
+  // The index of the deque of the current thread.
+  unsigned int QueueIndex() const;
+
+  void WorkerLoop(unsigned int index);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+
+  // The number of tasks in all deques, used to let idle workers and waiting
+  // task groups sleep. wake_ is notified when a task is added and when a group
+  // finishes.
+  std::atomic<int> queued_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  bool stop_ = false;
+};
+
+// A set of tasks that are run on a pool and waited for together. Tasks may add
+// more tasks to their own group, e.g. to split a search recursively.
+class TaskGroup {
+ public:
+  explicit TaskGroup(ThreadPool* pool) : pool_(pool) {}
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  // Waits for all tasks.
+  ~TaskGroup() { Wait(); }
+
+  // Starts a task.
+  void Run(std::function<void()> task);
+
+  // Runs tasks of the pool until all tasks of this group finished. When there
+  // is nothing left to run, the thread sleeps after spinning briefly.
+  void Wait();
+
+ private:
+  friend class ThreadPool;
+
+  ThreadPool* pool_;
+  std::atomic<int> pending_{0};
+};
+
+// Calls body(i) for each i in [begin, end) on a pool. The range is split in
+// halves until the parts have at most "grain" elements, so idle workers steal
+// large parts and cheap and expensive iterations are balanced dynamically.
+template <typename Body>
+void ParallelFor(ThreadPool* pool, int begin, int end, int grain,
+                 const Body& body);
+}
+}
+
+#include "util/concurrency/thread_pool.impl.h"
@@ -0,0 +1,34 @@
+
+#include <algorithm>
+
+namespace util {
+namespace concurrency {
+
+// Implementation details of ParallelFor.
+namespace internal {
+template <typename Body>
+void ParallelForRange(TaskGroup* group, int begin, int end, int grain,
+                      const Body& body) {
+  // Leave the upper halves to other workers and keep splitting the lower one.
+  while (end - begin > grain) {
+    const int middle = begin + (end - begin) / 2;
+    group->Run([group, middle, end, grain, &body]() {
+      ParallelForRange(group, middle, end, grain, body);
+    });
+    end = middle;
+  }
+  for (int i = begin; i < end; ++i) {
+    body(i);
+  }
+}
+}
+
+template <typename Body>
+void ParallelFor(ThreadPool* pool, int begin, int end, int grain,
+                 const Body& body) {
+  TaskGroup group(pool);
+  internal::ParallelForRange(&group, begin, end, std::max(grain, 1), body);
+  group.Wait();
+}
+}
+}
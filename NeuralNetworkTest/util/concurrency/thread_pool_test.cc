@@ -0,0 +1,82 @@
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "util/concurrency/thread_pool.h"
+#include "gtest/gtest.h"
+
+using util::concurrency::ParallelFor;
+using util::concurrency::TaskGroup;
+using util::concurrency::ThreadPool;
+
+namespace {
+// Sums the numbers in [begin, end) by splitting the range recursively.
+void RecursiveSum(TaskGroup* group, long begin, long end,
+                  std::atomic<long>* sum) {
+  if (end - begin <= 8) {
+    for (long i = begin; i < end; ++i) {
+      sum->fetch_add(i);
+    }
+    return;
+  }
+  const long middle = begin + (end - begin) / 2;
+  group->Run([=]() { RecursiveSum(group, begin, middle, sum); });
+  group->Run([=]() { RecursiveSum(group, middle, end, sum); });
+}
+}
+
+TEST(ThreadPoolTest, ParallelForTest) {
+  for (const unsigned int threads : {1u, 4u}) {
+    ThreadPool pool(threads);
+    EXPECT_EQ(pool.size(), threads);
+    for (const int grain : {1, 7, 1000}) {
+      std::vector<std::atomic<int>> calls(1000);
+      ParallelFor(&pool, 0, 1000, grain, [&calls](int i) { ++calls[i]; });
+      for (const std::atomic<int>& count : calls) {
+        EXPECT_EQ(count.load(), 1);
+      }
+    }
+
+    // An empty range.
+    ParallelFor(&pool, 5, 5, 1, [](int) { FAIL(); });
+  }
+}
+
+TEST(ThreadPoolTest, NestedTest) {
+  // Loops inside of tasks are run by the same pool without blocking it.
+  ThreadPool pool(2);
+  std::atomic<int> sum{0};
+  ParallelFor(&pool, 0, 10, 1, [&pool, &sum](int i) {
+    ParallelFor(&pool, 0, 10, 1, [&sum, i](int j) { sum += i * j; });
+  });
+  EXPECT_EQ(sum.load(), 45 * 45);
+}
+
+TEST(ThreadPoolTest, TaskGroupTest) {
+  ThreadPool pool(3);
+  std::atomic<long> sum{0};
+  TaskGroup group(&pool);
+  group.Run([&group, &sum]() { RecursiveSum(&group, 0, 10000, &sum); });
+  group.Wait();
+  EXPECT_EQ(sum.load(), 10000L * 9999 / 2);
+}
+
+TEST(ThreadPoolTest, SlowTaskTest) {
+  // Tasks that outlast the spinning of Wait make the waiting threads sleep
+  // until the last task finished.
+  ThreadPool pool(2);
+  std::atomic<int> finished{0};
+  for (int round = 0; round < 3; ++round) {
+    TaskGroup group(&pool);
+    for (int i = 0; i < 4; ++i) {
+      group.Run([&finished]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ++finished;
+      });
+    }
+    group.Wait();
+    EXPECT_EQ(finished.load(), 4 * (round + 1));
+  }
+}
@@ -0,0 +1,55 @@
+
+#include "util/memory/arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace util {
+namespace memory {
+
+Arena::Arena(std::size_t chunk_size) : chunk_size_(chunk_size) {}
+
+void* Arena::Allocate(std::size_t bytes, std::size_t alignment) {
+  // Find a chunk with enough space after aligning the offset.
+  std::size_t aligned_offset = (offset_ + alignment - 1) & ~(alignment - 1);
+  if (chunks_.empty() ||
+      aligned_offset + bytes > chunks_[current_chunk_].size) {
+    NextChunk(bytes + alignment);
+    aligned_offset = 0;
+  }
+
+  char* const chunk_memory = chunks_[current_chunk_].memory.get();
+  // The chunk itself might not be aligned for large alignments.
+  while (reinterpret_cast<std::uintptr_t>(chunk_memory + aligned_offset) &
+         (alignment - 1)) {
+    ++aligned_offset;
+  }
+  bytes_used_ += aligned_offset + bytes - offset_;
+  offset_ = aligned_offset + bytes;
+  return chunk_memory + aligned_offset;
+}
+
+void Arena::Reset() {
+  current_chunk_ = 0;
+  offset_ = 0;
+  bytes_used_ = 0;
+}
+
+std::size_t Arena::BytesUsed() const { return bytes_used_; }
+
+void Arena::NextChunk(std::size_t min_size) {
+  // Reuse the following chunks after a Reset if they are large enough.
+  std::size_t next_chunk = (chunks_.empty() ? 0 : current_chunk_ + 1);
+  while (next_chunk < chunks_.size() && chunks_[next_chunk].size < min_size) {
+    ++next_chunk;
+  }
+  if (next_chunk == chunks_.size()) {
+    const std::size_t size = std::max(chunk_size_, min_size);
+    chunks_.push_back(Chunk{std::unique_ptr<char[]>(new char[size]), size});
+  }
+  current_chunk_ = next_chunk;
+  offset_ = 0;
+}
+
+}
+}
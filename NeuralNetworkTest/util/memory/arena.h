@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace util {
+namespace memory {
+
+// A bump allocator. Memory is handed out from large chunks and is only
+// released as a whole by Reset or by destroying the arena. This makes
+// allocation cheap and keeps objects that are allocated together close to
+// each other in memory.
+class Arena {
+ public:
+  // Creates an arena that requests memory in chunks of at least the given
+  // size.
+  explicit Arena(std::size_t chunk_size = 1 << 20);
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Returns uninitialized memory of the given size. alignment has to be a
+  // power of two.
+  void* Allocate(std::size_t bytes, std::size_t alignment);
+
+  // Invalidates all memory that was allocated. The chunks are kept and reused
+  // by later allocations.
+  void Reset();
+
+  // The number of bytes handed out since the last Reset, including padding.
+  std::size_t BytesUsed() const;
+
+ private:
+  struct Chunk {
+    std::unique_ptr<char[]> memory;
+    std::size_t size;
+  };
+
+  // Makes a chunk with at least the given size the current chunk.
+  void NextChunk(std::size_t min_size);
+
+  std::size_t chunk_size_;
+  std::vector<Chunk> chunks_;
+
+  // The chunk that is currently used and the offset of its free part.
+  std::size_t current_chunk_ = 0;
+  std::size_t offset_ = 0;
+  std::size_t bytes_used_ = 0;
+};
+
+// A standard allocator that takes its memory from an arena. Deallocation does
+// nothing; the memory is reclaimed when the arena is reset. Without an arena,
+// the allocator uses the heap like std::allocator.
+//
+// Copies of containers are made on the heap, while moves and swaps keep the
+// arena of the source. Containers that use an arena must not be used after
+// the arena is reset.
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  ArenaAllocator() = default;
+  ArenaAllocator(Arena* arena) : arena_(arena) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+  T* allocate(std::size_t n);
+  void deallocate(T* pointer, std::size_t n);
+
+  ArenaAllocator select_on_container_copy_construction() const {
+    return ArenaAllocator();
+  }
+
+  // The arena the memory is taken from, or nullptr for the heap.
+  Arena* arena() const { return arena_; }
+
+ private:
+  Arena* arena_ = nullptr;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+  return lhs.arena() == rhs.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+  return !(lhs == rhs);
+}
+
+// A vector whose elements may be stored in an arena.
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+}
+}
+
+#include "util/memory/arena.impl.h"
@@ -0,0 +1,23 @@
+
+#include <new>
+
+namespace util {
+namespace memory {
+
+template <typename T>
+T* ArenaAllocator<T>::allocate(std::size_t n) {
+  if (arena_ == nullptr) {
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+  }
+  return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+}
+
+template <typename T>
+void ArenaAllocator<T>::deallocate(T* pointer, std::size_t) {
+  if (arena_ == nullptr) {
+    ::operator delete(pointer);
+  }
+}
+
+}
+}
@@ -0,0 +1,49 @@
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "util/memory/arena.h"
+
+namespace util {
+namespace memory {
+
+TEST(ArenaTest, AllocateTest) {
+  Arena arena(64);
+  char* const first = static_cast<char*>(arena.Allocate(10, 1));
+  char* const second = static_cast<char*>(arena.Allocate(10, 1));
+  EXPECT_EQ(first + 10, second);
+  EXPECT_EQ(arena.BytesUsed(), 20);
+
+  double* const aligned = static_cast<double*>(arena.Allocate(8, 8));
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned) % 8, 0);
+
+  // Allocations larger than a chunk get their own chunk.
+  void* const large = arena.Allocate(1000, 8);
+  EXPECT_NE(large, nullptr);
+}
+
+TEST(ArenaTest, ResetTest) {
+  Arena arena(64);
+  void* const first = arena.Allocate(32, 8);
+  arena.Allocate(48, 8);
+  arena.Reset();
+  EXPECT_EQ(arena.BytesUsed(), 0);
+  EXPECT_EQ(arena.Allocate(32, 8), first);
+}
+
+TEST(ArenaTest, ArenaVectorTest) {
+  Arena arena;
+  ArenaVector<int> in_arena(100, 1, ArenaAllocator<int>(&arena));
+  EXPECT_EQ(in_arena.get_allocator().arena(), &arena);
+  EXPECT_GE(arena.BytesUsed(), 100 * sizeof(int));
+
+  // Copies are made on the heap, moves keep the arena.
+  const ArenaVector<int> copy = in_arena;
+  EXPECT_EQ(copy.get_allocator().arena(), nullptr);
+  EXPECT_EQ(copy, in_arena);
+  const ArenaVector<int> moved = std::move(in_arena);
+  EXPECT_EQ(moved.get_allocator().arena(), &arena);
+  EXPECT_EQ(moved, copy);
+}
+}
+}